@@ -112,7 +112,17 @@ M68KMAKE_PROTOTYPE_FOOTER
 /* Build the opcode handler table */
 void m68ki_build_opcode_table(void);
 
+#ifdef M68KOPS_ONLY_CPU
+/* One CPU type: opcodes index a short handler list, with one cycle table */
+extern unsigned short m68ki_instruction_index[0x10000];
+extern void (*m68ki_instruction_handlers[M68KOPS_HANDLER_COUNT])(void);
+#define m68ki_instruction_handler(A) m68ki_instruction_handlers[m68ki_instruction_index[A]]
+#define m68ki_cycle_column(A) 0
+#else
 extern void (*m68ki_instruction_jump_table[0x10000])(void); /* opcode handler jump table */
+#define m68ki_instruction_handler(A) m68ki_instruction_jump_table[A]
+#define m68ki_cycle_column(A) (A)
+#endif
 extern unsigned char m68ki_cycles[][0x10000];
 
 
@@ -134,9 +144,16 @@ M68KMAKE_TABLE_HEADER
 #include <stdio.h>
 #include "m68kops.h"
 
+#ifdef M68KOPS_ONLY_CPU
+#define NUM_CPU_TYPES 1
+
+unsigned short m68ki_instruction_index[0x10000]; /* opcode to handler number */
+void (*m68ki_instruction_handlers[M68KOPS_HANDLER_COUNT])(void); /* handler list */
+#else
 #define NUM_CPU_TYPES 5
 
 void  (*m68ki_instruction_jump_table[0x10000])(void); /* opcode handler jump table */
+#endif
 unsigned char m68ki_cycles[NUM_CPU_TYPES][0x10000]; /* Cycles used by CPU type */
 
 /* This is used to generate the opcode handler jump table */
@@ -159,10 +176,24 @@ static const opcode_handler_struct m68k_opcode_handler_table[] =
 XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX
 M68KMAKE_TABLE_FOOTER
 
-	{0, 0, 0, {0, 0, 0, 0, 0}}
+	{0, 0, 0, {0}}
 };
 
 
+/* Point an opcode at a handler table entry */
+static void m68ki_set_opcode(int instr, const opcode_handler_struct *ostruct)
+{
+	int k;
+
+#ifdef M68KOPS_ONLY_CPU
+	m68ki_instruction_index[instr] = (unsigned short)(ostruct - m68k_opcode_handler_table + 1);
+#else
+	m68ki_instruction_jump_table[instr] = ostruct->opcode_handler;
+#endif
+	for(k=0;k<NUM_CPU_TYPES;k++)
+		m68ki_cycles[k][instr] = ostruct->cycles[k];
+}
+
 /* Build the opcode handler jump table */
 void m68ki_build_opcode_table(void)
 {
@@ -176,33 +207,35 @@ void m68ki_build_opcode_table(void)
 	for(i = 0; i < 0x10000; i++)
 	{
 		/* default to illegal */
+#ifdef M68KOPS_ONLY_CPU
+		m68ki_instruction_index[i] = 0;
+#else
 		m68ki_instruction_jump_table[i] = m68k_op_illegal;
+#endif
 		for(k=0;k<NUM_CPU_TYPES;k++)
 			m68ki_cycles[k][i] = 0;
 	}
 
+#ifdef M68KOPS_ONLY_CPU
+	m68ki_instruction_handlers[0] = m68k_op_illegal;
+	for(i = 1; i < M68KOPS_HANDLER_COUNT; i++)
+		m68ki_instruction_handlers[i] = m68k_opcode_handler_table[i-1].opcode_handler;
+#endif
+
 	ostruct = m68k_opcode_handler_table;
 	while(ostruct->mask != 0xff00)
 	{
 		for(i = 0;i < 0x10000;i++)
 		{
 			if((i & ostruct->mask) == ostruct->match)
-			{
-				m68ki_instruction_jump_table[i] = ostruct->opcode_handler;
-				for(k=0;k<NUM_CPU_TYPES;k++)
-					m68ki_cycles[k][i] = ostruct->cycles[k];
-			}
+				m68ki_set_opcode(i, ostruct);
 		}
 		ostruct++;
 	}
 	while(ostruct->mask == 0xff00)
 	{
 		for(i = 0;i <= 0xff;i++)
-		{
-			m68ki_instruction_jump_table[ostruct->match | i] = ostruct->opcode_handler;
-			for(k=0;k<NUM_CPU_TYPES;k++)
-				m68ki_cycles[k][ostruct->match | i] = ostruct->cycles[k];
-		}
+			m68ki_set_opcode(ostruct->match | i, ostruct);
 		ostruct++;
 	}
 	while(ostruct->mask == 0xf1f8)
@@ -212,19 +245,22 @@ void m68ki_build_opcode_table(void)
 			for(j = 0;j < 8;j++)
 			{
 				instr = ostruct->match | (i << 9) | j;
-				m68ki_instruction_jump_table[instr] = ostruct->opcode_handler;
-				for(k=0;k<NUM_CPU_TYPES;k++)
-					m68ki_cycles[k][instr] = ostruct->cycles[k];
+				m68ki_set_opcode(instr, ostruct);
 				// For all shift operations with known shift distance (encoded in instruction word)
 				if((instr & 0xf000) == 0xe000 && (!(instr & 0x20)))
 				{
 					// On the 68000 and 68010 shift distance affect execution time.
 					// Add the cycle cost of shifting; 2 times the shift distance
 					cycle_cost = ((((i-1)&7)+1)<<1);
+#ifdef M68KOPS_ONLY_CPU
+					if(M68KOPS_ONLY_CPU < 2)
+						m68ki_cycles[0][instr] += cycle_cost;
+#else
 					m68ki_cycles[0][instr] += cycle_cost;
 					m68ki_cycles[1][instr] += cycle_cost;
 					// On the 68020 shift distance does not affect execution time
 					m68ki_cycles[2][instr] += 0;
+#endif
 				}
 			}
 		}
@@ -233,38 +269,24 @@ void m68ki_build_opcode_table(void)
 	while(ostruct->mask == 0xfff0)
 	{
 		for(i = 0;i <= 0x0f;i++)
-		{
-			m68ki_instruction_jump_table[ostruct->match | i] = ostruct->opcode_handler;
-			for(k=0;k<NUM_CPU_TYPES;k++)
-				m68ki_cycles[k][ostruct->match | i] = ostruct->cycles[k];
-		}
+			m68ki_set_opcode(ostruct->match | i, ostruct);
 		ostruct++;
 	}
 	while(ostruct->mask == 0xf1ff)
 	{
 		for(i = 0;i <= 0x07;i++)
-		{
-			m68ki_instruction_jump_table[ostruct->match | (i << 9)] = ostruct->opcode_handler;
-			for(k=0;k<NUM_CPU_TYPES;k++)
-				m68ki_cycles[k][ostruct->match | (i << 9)] = ostruct->cycles[k];
-		}
+			m68ki_set_opcode(ostruct->match | (i << 9), ostruct);
 		ostruct++;
 	}
 	while(ostruct->mask == 0xfff8)
 	{
 		for(i = 0;i <= 0x07;i++)
-		{
-			m68ki_instruction_jump_table[ostruct->match | i] = ostruct->opcode_handler;
-			for(k=0;k<NUM_CPU_TYPES;k++)
-				m68ki_cycles[k][ostruct->match | i] = ostruct->cycles[k];
-		}
+			m68ki_set_opcode(ostruct->match | i, ostruct);
 		ostruct++;
 	}
 	while(ostruct->mask == 0xffff)
 	{
-		m68ki_instruction_jump_table[ostruct->match] = ostruct->opcode_handler;
-		for(k=0;k<NUM_CPU_TYPES;k++)
-			m68ki_cycles[k][ostruct->match] = ostruct->cycles[k];
+		m68ki_set_opcode(ostruct->match, ostruct);
 		ostruct++;
 	}
 }
@@ -613,6 +635,7 @@ lsl       16  r     .     1110...101101...  ..........  U U U U U   6   6   6
 lsl       32  r     .     1110...110101...  ..........  U U U U U   8   8   6   6   6
 lsl       16  .     .     1110001111......  A+-DXWL...  U U U U U   8   8   5   5   5
 move       8  d     d     0001...000000...  ..........  U U U U U   4   4   2   2   2
+move       8  d0    d0    0001000000000000  ..........  U U U U U   4   4   2   2   2
 move       8  d     .     0001...000......  A+-DXWLdxI  U U U U U   4   4   2   2   2
 move       8  ai    d     0001...010000...  ..........  U U U U U   8   8   4   4   4
 move       8  ai    .     0001...010......  A+-DXWLdxI  U U U U U   8   8   4   4   4
@@ -769,8 +792,11 @@ pack      16  mm    ay7   1000...101001111  ..........  . . U U U   .   .  13  1
 pack      16  mm    axy7  1000111101001111  ..........  . . U U U   .   .  13  13  13
 pack      16  mm    .     1000...101001...  ..........  . . U U U   .   .  13  13  13
 pea       32  .     .     0100100001......  A..DXWLdx.  U U U U U   6   6   5   5   5
-pflush    32  .     .     1111010100011000  ..........  . . . . S   .   .   .   .   4   TODO: correct timing
+pflush    32  .     .     111101010000....  ..........  . . . . S   .   .   .   .   4   TODO: correct timing
+pflush    32  a     .     111101010001....  ..........  . . . . S   .   .   .   .   4   TODO: correct timing
 pmmu      32  .     .     1111000.........  ..........  . . S S S   .   .   8   8   8
+ptest     32  r     .     1111010101101...  ..........  . . . . S   .   .   .   .   8   TODO: correct timing
+ptest     32  w     .     1111010101001...  ..........  . . . . S   .   .   .   .   8   TODO: correct timing
 reset      0  .     .     0100111001110000  ..........  S S S S S   0   0   0   0   0
 ror        8  s     .     1110...000011...  ..........  U U U U U   6   6   8   8   8
 ror       16  s     .     1110...001011...  ..........  U U U U U   6   6   8   8   8
@@ -4390,6 +4416,10 @@ M68KMAKE_OP(dbf, 16, ., .)
 		m68ki_trace_t0();			   /* auto-disable (see m68kcpu.h) */
 		m68ki_branch_16(offset);
 		USE_CYCLES(CYC_DBCC_F_NOEXP);
+#if M68K_BLOCK_MOVE
+		if(offset == 0xfffc && res != 0)   /* Back to the instruction before */
+			m68ki_block_move_loop(r_dst);
+#endif
 		return;
 	}
 	REG_PC += 2;
@@ -5671,6 +5701,26 @@ M68KMAKE_OP(move, 8, d, d)
 }
 
 
+M68KMAKE_OP(move, 8, d0, d0)
+{
+	uint res = MASK_OUT_ABOVE_8(REG_D[0]);
+
+	if(m68ki_moved0d0_callback(REG_PPC))	   /* auto-disable (see m68kcpu.h) */
+	{
+		/* Stop before it, as at a breakpoint, so it hasn't run */
+		REG_PC = REG_PPC;
+		m68k_end_timeslice();
+		ADD_CYCLES(CYC_INSTRUCTION[REG_IR]);
+		return;
+	}
+
+	FLAG_N = NFLAG_8(res);
+	FLAG_Z = res;
+	FLAG_V = VFLAG_CLEAR;
+	FLAG_C = CFLAG_CLEAR;
+}
+
+
 M68KMAKE_OP(move, 8, d, .)
 {
 	uint res = M68KMAKE_GET_OPER_AY_8;
@@ -6809,7 +6859,7 @@ M68KMAKE_OP(movec, 32, cr, .)
 			case 0x003:				/* TC */
 				if(CPU_TYPE_IS_040_PLUS(CPU_TYPE))
 				{
-					/* TODO */
+					REG_DA[(word2 >> 12) & 15] = m68ki_cpu.mmu_tc;
 					return;
 				}
 				m68ki_exception_illegal();
@@ -6817,7 +6867,7 @@ M68KMAKE_OP(movec, 32, cr, .)
 			case 0x004:				/* ITT0 */
 				if(CPU_TYPE_IS_040_PLUS(CPU_TYPE))
 				{
-					/* TODO */
+					REG_DA[(word2 >> 12) & 15] = m68ki_cpu.mmu_tt[0];
 					return;
 				}
 				m68ki_exception_illegal();
@@ -6825,7 +6875,7 @@ M68KMAKE_OP(movec, 32, cr, .)
 			case 0x005:				/* ITT1 */
 				if(CPU_TYPE_IS_040_PLUS(CPU_TYPE))
 				{
-					/* TODO */
+					REG_DA[(word2 >> 12) & 15] = m68ki_cpu.mmu_tt[1];
 					return;
 				}
 				m68ki_exception_illegal();
@@ -6833,7 +6883,7 @@ M68KMAKE_OP(movec, 32, cr, .)
 			case 0x006:				/* DTT0 */
 				if(CPU_TYPE_IS_040_PLUS(CPU_TYPE))
 				{
-					/* TODO */
+					REG_DA[(word2 >> 12) & 15] = m68ki_cpu.mmu_tt[2];
 					return;
 				}
 				m68ki_exception_illegal();
@@ -6841,7 +6891,7 @@ M68KMAKE_OP(movec, 32, cr, .)
 			case 0x007:				/* DTT1 */
 				if(CPU_TYPE_IS_040_PLUS(CPU_TYPE))
 				{
-					/* TODO */
+					REG_DA[(word2 >> 12) & 15] = m68ki_cpu.mmu_tt[3];
 					return;
 				}
 				m68ki_exception_illegal();
@@ -6849,7 +6899,7 @@ M68KMAKE_OP(movec, 32, cr, .)
 			case 0x805:				/* MMUSR */
 				if(CPU_TYPE_IS_040_PLUS(CPU_TYPE))
 				{
-					/* TODO */
+					REG_DA[(word2 >> 12) & 15] = m68ki_cpu.mmu_mmusr;
 					return;
 				}
 				m68ki_exception_illegal();
@@ -6857,7 +6907,7 @@ M68KMAKE_OP(movec, 32, cr, .)
 			case 0x806:				/* URP */
 				if(CPU_TYPE_IS_040_PLUS(CPU_TYPE))
 				{
-					/* TODO */
+					REG_DA[(word2 >> 12) & 15] = m68ki_cpu.mmu_urp_aptr;
 					return;
 				}
 				m68ki_exception_illegal();
@@ -6865,7 +6915,7 @@ M68KMAKE_OP(movec, 32, cr, .)
 			case 0x807:				/* SRP */
 				if(CPU_TYPE_IS_040_PLUS(CPU_TYPE))
 				{
-					/* TODO */
+					REG_DA[(word2 >> 12) & 15] = m68ki_cpu.mmu_srp_aptr;
 					return;
 				}
 				m68ki_exception_illegal();
@@ -6964,7 +7014,7 @@ M68KMAKE_OP(movec, 32, rc, .)
 			case 0x003:			/* TC */
 				if (CPU_TYPE_IS_040_PLUS(CPU_TYPE))
 				{
-					/* TODO */
+					m68ki_mmu_movec(0x003, REG_DA[(word2 >> 12) & 15]);
 					return;
 				}
 				m68ki_exception_illegal();
@@ -6972,7 +7022,7 @@ M68KMAKE_OP(movec, 32, rc, .)
 			case 0x004:			/* ITT0 */
 				if (CPU_TYPE_IS_040_PLUS(CPU_TYPE))
 				{
-					/* TODO */
+					m68ki_mmu_movec(0x004, REG_DA[(word2 >> 12) & 15]);
 					return;
 				}
 				m68ki_exception_illegal();
@@ -6980,7 +7030,7 @@ M68KMAKE_OP(movec, 32, rc, .)
 			case 0x005:			/* ITT1 */
 				if (CPU_TYPE_IS_040_PLUS(CPU_TYPE))
 				{
-					/* TODO */
+					m68ki_mmu_movec(0x005, REG_DA[(word2 >> 12) & 15]);
 					return;
 				}
 				m68ki_exception_illegal();
@@ -6988,7 +7038,7 @@ M68KMAKE_OP(movec, 32, rc, .)
 			case 0x006:			/* DTT0 */
 				if (CPU_TYPE_IS_040_PLUS(CPU_TYPE))
 				{
-					/* TODO */
+					m68ki_mmu_movec(0x006, REG_DA[(word2 >> 12) & 15]);
 					return;
 				}
 				m68ki_exception_illegal();
@@ -6996,7 +7046,7 @@ M68KMAKE_OP(movec, 32, rc, .)
 			case 0x007:			/* DTT1 */
 				if (CPU_TYPE_IS_040_PLUS(CPU_TYPE))
 				{
-					/* TODO */
+					m68ki_mmu_movec(0x007, REG_DA[(word2 >> 12) & 15]);
 					return;
 				}
 				m68ki_exception_illegal();
@@ -7004,7 +7054,7 @@ M68KMAKE_OP(movec, 32, rc, .)
 			case 0x805:			/* MMUSR */
 				if (CPU_TYPE_IS_040_PLUS(CPU_TYPE))
 				{
-					/* TODO */
+					m68ki_cpu.mmu_mmusr = REG_DA[(word2 >> 12) & 15];
 					return;
 				}
 				m68ki_exception_illegal();
@@ -7012,7 +7062,7 @@ M68KMAKE_OP(movec, 32, rc, .)
 			case 0x806:			/* URP */
 				if (CPU_TYPE_IS_040_PLUS(CPU_TYPE))
 				{
-					/* TODO */
+					m68ki_mmu_movec(0x806, REG_DA[(word2 >> 12) & 15]);
 					return;
 				}
 				m68ki_exception_illegal();
@@ -7020,7 +7070,7 @@ M68KMAKE_OP(movec, 32, rc, .)
 			case 0x807:			/* SRP */
 				if (CPU_TYPE_IS_040_PLUS(CPU_TYPE))
 				{
-					/* TODO */
+					m68ki_mmu_movec(0x807, REG_DA[(word2 >> 12) & 15]);
 					return;
 				}
 				m68ki_exception_illegal();
@@ -7427,10 +7477,15 @@ M68KMAKE_OP(move16, 32, ., .)
 	int ax = REG_IR & 7;
 	int ay = (w2 >> 12) & 7;
 
-	m68ki_write_32(REG_A[ay],    m68ki_read_32(REG_A[ax]));
-	m68ki_write_32(REG_A[ay]+4,  m68ki_read_32(REG_A[ax]+4));
-	m68ki_write_32(REG_A[ay]+8,  m68ki_read_32(REG_A[ax]+8));
-	m68ki_write_32(REG_A[ay]+12, m68ki_read_32(REG_A[ax]+12));
+#if M68K_BLOCK_MOVE
+	if(!m68ki_block_move16(REG_A[ax], REG_A[ay]))
+#endif
+	{
+		m68ki_write_32(REG_A[ay],    m68ki_read_32(REG_A[ax]));
+		m68ki_write_32(REG_A[ay]+4,  m68ki_read_32(REG_A[ax]+4));
+		m68ki_write_32(REG_A[ay]+8,  m68ki_read_32(REG_A[ax]+8));
+		m68ki_write_32(REG_A[ay]+12, m68ki_read_32(REG_A[ax]+12));
+	}
 
 	REG_A[ax] += 16;
 	REG_A[ay] += 16;
@@ -8379,7 +8434,30 @@ M68KMAKE_OP(pflush, 32, ., .)
 {
 	if ((CPU_TYPE_IS_EC020_PLUS(CPU_TYPE)) && (HAS_PMMU))
 	{
-		fprintf(stderr,"68040: unhandled PFLUSH\n");
+		if(FLAG_S)
+		{
+			/* PFLUSHN (An) and PFLUSH (An) */
+			m68ki_mmu_pflush(AY, 0);
+			return;
+		}
+		m68ki_exception_privilege_violation();
+		return;
+	}
+	m68ki_exception_1111();
+}
+
+
+M68KMAKE_OP(pflush, 32, a, .)
+{
+	if ((CPU_TYPE_IS_EC020_PLUS(CPU_TYPE)) && (HAS_PMMU))
+	{
+		if(FLAG_S)
+		{
+			/* PFLUSHAN and PFLUSHA */
+			m68ki_mmu_pflush(0, 1);
+			return;
+		}
+		m68ki_exception_privilege_violation();
 		return;
 	}
 	m68ki_exception_1111();
@@ -8397,6 +8475,40 @@ M68KMAKE_OP(pmmu, 32, ., .)
 	}
 }
 
+M68KMAKE_OP(ptest, 32, r, .)
+{
+	if ((CPU_TYPE_IS_EC020_PLUS(CPU_TYPE)) && (HAS_PMMU))
+	{
+		if(FLAG_S)
+		{
+			/* PTESTR (An) in the space DFC selects */
+			m68ki_mmu_ptest(AY, REG_DFC, 0);
+			return;
+		}
+		m68ki_exception_privilege_violation();
+		return;
+	}
+	m68ki_exception_1111();
+}
+
+
+M68KMAKE_OP(ptest, 32, w, .)
+{
+	if ((CPU_TYPE_IS_EC020_PLUS(CPU_TYPE)) && (HAS_PMMU))
+	{
+		if(FLAG_S)
+		{
+			/* PTESTW (An) in the space DFC selects */
+			m68ki_mmu_ptest(AY, REG_DFC, 1);
+			return;
+		}
+		m68ki_exception_privilege_violation();
+		return;
+	}
+	m68ki_exception_1111();
+}
+
+
 M68KMAKE_OP(reset, 0, ., .)
 {
 	if(FLAG_S)
@@ -9299,6 +9411,16 @@ rte_loop:
 				CPU_INSTR_MODE = INSTRUCTION_YES;
 				CPU_RUN_MODE = RUN_MODE_NORMAL;
 				return;
+			case 7: /* 68040 access error, no writebacks so rerun the instruction */
+				new_sr = m68ki_pull_16();
+				new_pc = m68ki_pull_32();
+				m68ki_fake_pull_16();	/* format word */
+				REG_SP += 52;			/* effective address to push data */
+				m68ki_jump(new_pc);
+				m68ki_set_sr(new_sr);
+				CPU_INSTR_MODE = INSTRUCTION_YES;
+				CPU_RUN_MODE = RUN_MODE_NORMAL;
+				return;
 		}
 		/* Not handling long or short bus fault */
 		CPU_INSTR_MODE = INSTRUCTION_YES;
@@ -0,0 +1,372 @@
+/* ======================================================================== */
+/* ========================= LICENSING & COPYRIGHT ======================== */
+/* ======================================================================== */
+/*
+ * Copyright Karl Stenerud.  All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * m68kblock.h - basic block cache for m68k_execute()
+ *
+ * The first time code at an address is run, the instructions executed are
+ * recorded into a block: the address, opcode, handler and cycle count of
+ * each one.  Next time the block is replayed without fetching or decoding
+ * the opcodes, as long as the PC matches the address recorded for each
+ * instruction.  A branch going a different way just ends the replay.
+ * Only the opcode word is cached; the handlers still read the extension
+ * words and work out the effective addresses.  The host is told about each
+ * address that is cached with M68K_BLOCK_CACHE_CALLBACK and must call
+ * m68k_invalidate_code() when one of them is written.
+ *
+ * With M68K_IDLE_LOOP a short loop of blocks which comes round without
+ * changing anything is taken as the CPU waiting for an event and the rest
+ * of the timeslice is skipped.
+ */
+
+#if M68K_BLOCK_CACHE
+
+/* Blocks are translated to host code (m68kjit.h) on x86-64 hosts, unless
+ * something has to be checked on every instruction.
+ */
+#if M68K_JIT && defined(__x86_64__) && !defined(_WIN32) && !M68K_EMULATE_TRACE && \
+	!M68K_EMULATE_FC && !M68K_INSTRUCTION_HOOK && M68K_BREAKPOINT_HOOK != OPT_ON
+#define M68KI_JIT 1
+#else
+#define M68KI_JIT 0
+#endif
+
+#define M68K_BLOCK_COUNT    2048   /* Number of blocks, must be a power of 2 */
+#define M68K_BLOCK_LENGTH   32     /* Maximum instructions in a block */
+#define M68K_BLOCK_INVALID  1      /* An odd address, never matches the PC */
+
+typedef struct
+{
+	void (*handler)(void);  /* Opcode handler */
+	uint pc;                /* Address of the instruction */
+	uint16 ir;              /* Opcode */
+	uint8 cycles;           /* Base cycle count */
+} m68ki_block_entry;
+
+typedef struct
+{
+	uint start;             /* Address of first instruction, M68K_BLOCK_INVALID if empty */
+	uint low, high;         /* Range of instruction addresses in the block */
+	uint length;            /* Number of instructions */
+#if M68KI_JIT
+	void (*code)(void);     /* Host code, NULL if not translated */
+	uint hits;              /* Times replayed */
+#endif
+	m68ki_block_entry entry[M68K_BLOCK_LENGTH];
+} m68ki_block;
+
+static M68K_THREAD_LOCAL m68ki_block m68ki_blocks[M68K_BLOCK_COUNT];
+static M68K_THREAD_LOCAL m68ki_block *m68ki_block_rec = NULL;  /* Block being recorded, if any */
+static M68K_THREAD_LOCAL uint m68ki_block_rec_pc;              /* Address it will start at */
+
+#if M68K_BLOCK_CACHE == OPT_SPECIFY_HANDLER
+#define m68ki_block_cacheable(A) M68K_BLOCK_CACHE_CALLBACK(A)
+#else
+#define m68ki_block_cacheable(A) 1
+#endif
+
+#define m68ki_block_slot(A) (&m68ki_blocks[((A) >> 1) & (M68K_BLOCK_COUNT-1)])
+
+/* Empty the whole cache */
+void m68k_flush_code_cache(void)
+{
+	int i;
+	for(i = 0; i < M68K_BLOCK_COUNT; i++)
+	{
+		m68ki_blocks[i].start = M68K_BLOCK_INVALID;
+		m68ki_blocks[i].length = 0;
+#if M68KI_JIT
+		m68ki_blocks[i].code = NULL;
+		m68ki_blocks[i].hits = 0;
+#endif
+	}
+	m68ki_block_rec = NULL;
+}
+
+/* Throw away a block, any replay of it stops at the next instruction */
+static void m68ki_block_kill(m68ki_block *block)
+{
+	uint i;
+	for(i = 0; i < block->length; i++)
+		block->entry[i].pc = M68K_BLOCK_INVALID;
+	block->start = M68K_BLOCK_INVALID;
+	block->length = 0;
+#if M68KI_JIT
+	block->code = NULL;
+	block->hits = 0;
+#endif
+}
+
+/* The host has written to memory which may hold cached opcodes */
+void m68k_invalidate_code(unsigned int address, unsigned int size)
+{
+	int i;
+	uint end = address + size - 1;
+	for(i = 0; i < M68K_BLOCK_COUNT; i++)
+	{
+		m68ki_block *block = &m68ki_blocks[i];
+		if(block->length != 0 && block->low <= end && block->high >= address)
+			m68ki_block_kill(block);
+	}
+	if(m68ki_block_rec != NULL)   /* Start the one being recorded again */
+	{
+		m68ki_block_rec->length = 0;
+		m68ki_block_rec = NULL;
+	}
+}
+
+/* Finish recording, the block is whatever has been run so far */
+static inline void m68ki_block_end_record(void)
+{
+	if(m68ki_block_rec != NULL)
+	{
+		if(m68ki_block_rec->length != 0)
+			m68ki_block_rec->start = m68ki_block_rec_pc;
+		m68ki_block_rec = NULL;
+	}
+}
+
+/* Find the block starting at pc, or start recording one and return NULL */
+static inline m68ki_block *m68ki_block_lookup(uint pc)
+{
+	m68ki_block *block = m68ki_block_slot(pc);
+
+#if M68K_EMULATE_TRACE
+	if(FLAG_T1)
+		return NULL;
+#endif
+#if M68K_EMULATE_PMMU
+	if(PMMU_ENABLED)
+		return NULL;
+#endif
+	if(block->start == pc)
+	{
+		m68ki_block_end_record();   /* Recording runs into this block */
+		return block;
+	}
+	if(m68ki_block_rec == NULL)
+	{
+		m68ki_block_kill(block);
+		m68ki_block_rec = block;
+		m68ki_block_rec_pc = pc;
+	}
+	return NULL;
+}
+
+/* Add the instruction just fetched to the block being recorded */
+static inline void m68ki_block_record(uint pc)
+{
+	m68ki_block *block = m68ki_block_rec;
+	m68ki_block_entry *e;
+
+	if(block == NULL)
+		return;
+	if(!m68ki_block_cacheable(pc))   /* Host can't tell us if it changes */
+	{
+		block->length = 0;
+		m68ki_block_rec = NULL;
+		return;
+	}
+	e = &block->entry[block->length++];
+	e->handler = m68ki_instruction_handler(REG_IR);
+	e->pc = pc;
+	e->ir = REG_IR;
+	e->cycles = CYC_INSTRUCTION[REG_IR];
+	if(block->length == 1 || pc < block->low)
+		block->low = pc;
+	if(block->length == 1 || pc + 1 > block->high)
+		block->high = pc + 1;
+	if(block->length == M68K_BLOCK_LENGTH)
+	{
+		block->start = m68ki_block_rec_pc;
+		m68ki_block_rec = NULL;
+	}
+}
+
+#if M68K_IDLE_LOOP
+
+/* Idle loop detection.  One block start at a time is watched, and every so
+ * many times the PC gets back to it the registers are compared with last
+ * time.  If they are the same, nothing has been written and the host says
+ * the reads would give the same again, the loop can't get anywhere until an
+ * event comes in.  Calls in the loop push and pop things on the stack, so
+ * writes there aren't counted: below the SP it is dead once they return, and
+ * the few bytes above are compared instead, once the registers have matched.
+ * A block entered with a higher SP (a return out of the one being watched)
+ * is watched instead, so that is the outermost part of the loop.
+ */
+#define M68K_IDLE_LOOP_BLOCKS  64     /* Blocks before watching another start */
+#define M68K_IDLE_LOOP_VISITS  16     /* Times round between comparisons */
+
+#if M68K_IDLE_LOOP == OPT_SPECIFY_HANDLER
+#define m68ki_idle_reads_repeat() M68K_IDLE_LOOP_CALLBACK()
+#else
+#define m68ki_idle_reads_repeat() 1
+#endif
+
+static M68K_THREAD_LOCAL int m68ki_idle_enabled = 1;
+static M68K_THREAD_LOCAL uint m68ki_idle_pc = M68K_BLOCK_INVALID;  /* Block start being watched */
+static M68K_THREAD_LOCAL uint m68ki_idle_blocks;                   /* Blocks run since it was last seen */
+static M68K_THREAD_LOCAL uint m68ki_idle_visits;                   /* Times seen since the last comparison */
+static M68K_THREAD_LOCAL uint m68ki_idle_writes;                   /* Writes counted then */
+static M68K_THREAD_LOCAL uint m68ki_idle_sr;                       /* Registers then */
+static M68K_THREAD_LOCAL uint m68ki_idle_dar[16];
+static M68K_THREAD_LOCAL int m68ki_idle_framed;                    /* Non zero if the frame has been read */
+static M68K_THREAD_LOCAL uint m68ki_idle_frame[M68K_IDLE_FRAME_BYTES / 4];
+static M68K_THREAD_LOCAL uint m68ki_idle_skips;                    /* Timeslices skipped so far */
+
+/* Remember the state at the start of block, to compare with later */
+static void m68ki_idle_watch(m68ki_block *block)
+{
+	m68ki_idle_pc = block->start;
+	m68ki_idle_blocks = 0;
+	m68ki_idle_visits = 0;
+	m68ki_idle_writes = m68ki_cpu.writes;
+	m68ki_idle_sr = m68ki_get_sr();
+	memcpy(m68ki_idle_dar, REG_DA, sizeof(REG_DA));
+	m68ki_idle_framed = 0;
+	m68ki_cpu.idle_stack = REG_A[7] - M68K_IDLE_STACK_BYTES;
+}
+
+/* Read the stack above the SP, non zero if it is as it was last time */
+static int m68ki_idle_same_frame(void)
+{
+	int same = m68ki_idle_framed;
+	uint i;
+
+	for(i = 0; i < M68K_IDLE_FRAME_BYTES / 4; i++)
+	{
+		uint data = m68k_read_memory_32(ADDRESS_68K(REG_A[7] + i * 4));
+		same = same && data == m68ki_idle_frame[i];
+		m68ki_idle_frame[i] = data;
+	}
+	m68ki_idle_framed = 1;
+	return same;
+}
+
+/* Back at the start being watched, non zero if nothing has changed.  The
+ * host's reads go back to before it was watched the first time round, which
+ * can only make it look busy.  After a skip it has to go round again before
+ * the next comparison, so what it polls is read once more.
+ */
+static int m68ki_idle_compare(m68ki_block *block)
+{
+	int reads = m68ki_idle_reads_repeat();
+
+	if(!reads || m68ki_idle_writes != m68ki_cpu.writes || m68ki_idle_sr != m68ki_get_sr() ||
+		memcmp(m68ki_idle_dar, REG_DA, sizeof(REG_DA)) != 0)
+	{
+		m68ki_idle_watch(block);
+		return 0;
+	}
+	if(!m68ki_idle_same_frame())
+	{
+		m68ki_idle_visits = 0;
+		return 0;
+	}
+	m68ki_idle_visits = 0;
+	return 1;
+}
+
+/* About to run block, non zero if the CPU is polling and can skip ahead */
+static inline int m68ki_idle_loop(m68ki_block *block)
+{
+	if(block->start == m68ki_idle_pc)
+	{
+		m68ki_idle_blocks = 0;
+		if(++m68ki_idle_visits < M68K_IDLE_LOOP_VISITS || !m68ki_idle_compare(block))
+			return 0;
+		m68ki_idle_skips++;
+		return 1;
+	}
+	if((++m68ki_idle_blocks >= M68K_IDLE_LOOP_BLOCKS || REG_A[7] > m68ki_idle_dar[15]) && m68ki_idle_enabled)
+		m68ki_idle_watch(block);   /* Not a short loop, or this is outside it */
+	return 0;
+}
+
+void m68k_forget_idle_loop(void)
+{
+	m68ki_idle_pc = M68K_BLOCK_INVALID;
+	m68ki_idle_blocks = 0;
+}
+
+void m68k_set_idle_skip(int enable)
+{
+	m68ki_idle_enabled = enable;
+	m68k_forget_idle_loop();
+}
+
+unsigned int m68k_idle_skips(void)
+{
+	return m68ki_idle_skips;
+}
+
+#else
+
+void m68k_forget_idle_loop(void)
+{
+}
+
+void m68k_set_idle_skip(int enable)
+{
+	(void)enable;
+}
+
+unsigned int m68k_idle_skips(void)
+{
+	return 0;
+}
+
+#endif /* M68K_IDLE_LOOP */
+
+#else
+
+#define M68KI_JIT 0
+
+void m68k_flush_code_cache(void)
+{
+}
+
+void m68k_invalidate_code(unsigned int address, unsigned int size)
+{
+	(void)address;
+	(void)size;
+}
+
+void m68k_forget_idle_loop(void)
+{
+}
+
+void m68k_set_idle_skip(int enable)
+{
+	(void)enable;
+}
+
+unsigned int m68k_idle_skips(void)
+{
+	return 0;
+}
+
+#endif /* M68K_BLOCK_CACHE */
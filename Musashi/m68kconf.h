@@ -165,10 +165,56 @@
 #define M68K_INSTRUCTION_CALLBACK(pc) your_instruction_hook_function(pc)
 
 
+/* If ON, CPU will call the breakpoint callback before every instruction.
+ * If it returns non zero, m68k_execute() ends the timeslice and returns
+ * without executing the instruction at pc.
+ * With OPT_SPECIFY_HANDLER the callback is only made if M68K_BREAKPOINT_PAGE
+ * is non zero for pc, so it can be a cheap inline test of a page bitmap.
+ */
+#define M68K_BREAKPOINT_HOOK        OPT_SPECIFY_HANDLER
+#define M68K_BREAKPOINT_PAGE(pc)    (CPUBreakPages[(pc) >> 15] & (1 << (((pc) >> 12) & 7)))
+#define M68K_BREAKPOINT_CALLBACK(pc) CPUBreakpointHook(pc)
+
+
+/* If ON, CPU will call the move.b d0,d0 callback when it reaches that
+ * instruction (opcode $1000), which is used as a software breakpoint.  If it
+ * returns non zero the CPU stops before the instruction, as for a breakpoint.
+ */
+#define M68K_MOVED0D0_HAS_CALLBACK  OPT_SPECIFY_HANDLER
+#define M68K_MOVED0D0_CALLBACK(pc)  CPUMoveD0D0Hook(pc)
+
+
 /* If ON, the CPU will emulate the 4-byte prefetch queue of a real 68000 */
 #define M68K_EMULATE_PREFETCH       OPT_OFF
 
 
+/* If ON, instruction fetches read straight from host memory.  The CPU keeps
+ * the host pointer for the block of memory holding the PC and only calls the
+ * fetch pointer callback when the PC leaves it.  The callback returns the host
+ * address of start, and fills in start and size, or NULL if the address is
+ * not plain memory.  Not used when M68K_EMULATE_PREFETCH is on.
+ */
+#define M68K_FETCH_POINTER          OPT_SPECIFY_HANDLER
+#define M68K_FETCH_POINTER_CALLBACK(A,S,L) MEMGetFetchPointer(A,S,L)
+
+
+/* If ON, m68k_execute() records the instructions it runs into blocks and
+ * replays them without fetching or decoding the opcodes again (m68kblock.h).
+ * With OPT_SPECIFY_HANDLER the callback is made for each opcode address that
+ * is cached, and returns 0 if it cannot be cached.  The host must then call
+ * m68k_invalidate_code() when it writes to any of those addresses.
+ */
+#define M68K_BLOCK_CACHE            OPT_SPECIFY_HANDLER
+#define M68K_BLOCK_CACHE_CALLBACK(A) MEMMarkCode(A)
+
+
+/* If ON, m68k_set_jit() can turn on translation of frequently run blocks
+ * into x86-64 code (m68kjit.h).  Needs M68K_BLOCK_CACHE, and does nothing
+ * on other hosts.
+ */
+#define M68K_JIT                    OPT_ON
+
+
 /* If ON, the CPU will generate address error exceptions if it tries to
  * access a word or longword at an odd address.
  * NOTE: This is only emulated properly for 68000 mode.
@@ -176,6 +222,48 @@
 #define M68K_EMULATE_ADDRESS_ERROR  OPT_OFF
 
 
+/* If ON, the D/A registers are copied before every instruction so that a
+ * bus error (m68k_pulse_bus_error() or a PMMU fault) can put them back.
+ * If OFF a bus error still takes the exception, but registers the faulting
+ * instruction had already changed stay changed.
+ */
+#define M68K_EMULATE_BUS_ERROR      OPT_OFF
+
+
+/* If ON, a short loop in the block cache which gets back to its start with
+ * the same registers and status register, having written nothing except to
+ * its own stack, is taken to be polling for something to happen and the rest
+ * of the timeslice is skipped, as it is after STOP.  The host should end
+ * timeslices at anything that could change what is being polled, and call
+ * m68k_forget_idle_loop() when it does.  With OPT_SPECIFY_HANDLER the
+ * callback is made each time round such a loop and returns non zero only if
+ * everything read since the last call would read the same again.
+ */
+#define M68K_IDLE_LOOP              OPT_SPECIFY_HANDLER
+#define M68K_IDLE_LOOP_CALLBACK()   MEMIdleReads()
+
+
+/* If ON, MOVE16 and loops of a copy or fill through (An)+ followed by a DBRA
+ * back to it are done with a host memmove or memset, when the host pointer
+ * callback gives host memory for both ranges.  It returns the host address of
+ * address to address+size-1, which must be one array, or NULL if that is not
+ * all plain memory.  write is non zero if the CPU is about to write it.  The
+ * registers, flags and cycles used come out as if each instruction had run.
+ */
+#define M68K_BLOCK_MOVE             OPT_SPECIFY_HANDLER
+#define M68K_BLOCK_MOVE_CALLBACK(A,S,W) MEMGetHostPointer(A,S,W)
+
+
+/* If ON, m68k_set_fpu_mode() can have FADD, FSUB, FMUL, FDIV, FSQRT and FCMP
+ * done in host floating point rather than softfloat: long double on x86 and
+ * x86-64, which is the same 80 bit format, and double on other hosts.  Only
+ * zero and normal operands and results with round to nearest are done on the
+ * host, NaNs, infinities, denormals and the other rounding modes still go to
+ * softfloat.
+ */
+#define M68K_FPU_HOST               OPT_ON
+
+
 /* Turn ON to enable logging of illegal instruction calls.
  * M68K_LOG_FILEHANDLE must be #defined to a stdio file stream.
  * Turn on M68K_LOG_1010_1111 to log all 1010 and 1111 calls.
@@ -186,7 +274,15 @@
 
 /* Emulate PMMU : if you enable this, there will be a test to see if the current chip has some enabled pmmu added to every memory access,
  * so enable this only if it's useful */
-#define M68K_EMULATE_PMMU   OPT_OFF
+#define M68K_EMULATE_PMMU   OPT_ON
+
+/* If ON, the CPU state, the block cache, the JIT and the softfloat modes are
+ * thread local, so each thread runs its own CPU.  Each of those threads calls
+ * m68k_init(), and the shared opcode table is built by whichever call comes
+ * first.  This uses pthreads, except with MSVC, where the first call must
+ * have finished before another thread makes one.
+ */
+#define M68K_PER_THREAD             OPT_ON
 
 /* ----------------------------- COMPATIBILITY ---------------------------- */
 
@@ -41,24 +41,27 @@
 extern void m68040_fpu_op0(void);
 extern void m68040_fpu_op1(void);
 extern void m68881_mmu_ops(void);
-extern unsigned char m68ki_cycles[][0x10000];
-extern void (*m68ki_instruction_jump_table[0x10000])(void); /* opcode handler jump table */
 extern void m68ki_build_opcode_table(void);
 
 #include "m68kops.h"
 #include "m68kcpu.h"
+#if M68K_PER_THREAD && !defined(_MSC_VER)
+#include <pthread.h>
+#endif
 
 #include "m68kfpu.c"
 #include "m68kmmu.h" // uses some functions from m68kfpu.c which are static !
+#include "m68kblock.h"
+#include "m68kjit.h"
 
 /* ======================================================================== */
 /* ================================= DATA ================================= */
 /* ======================================================================== */
 
-int  m68ki_initial_cycles;
-int  m68ki_remaining_cycles = 0;                     /* Number of clocks remaining */
-uint m68ki_tracing = 0;
-uint m68ki_address_space;
+M68K_THREAD_LOCAL int  m68ki_initial_cycles;
+M68K_THREAD_LOCAL int  m68ki_remaining_cycles = 0;   /* Number of clocks remaining */
+M68K_THREAD_LOCAL uint m68ki_tracing = 0;
+M68K_THREAD_LOCAL uint m68ki_address_space;
 
 #ifdef M68K_LOG_ENABLE
 const char *const m68ki_cpu_names[] =
@@ -78,21 +81,21 @@ const char *const m68ki_cpu_names[] =
 #endif /* M68K_LOG_ENABLE */
 
 /* The CPU core */
-m68ki_cpu_core m68ki_cpu = {0};
+M68K_THREAD_LOCAL m68ki_cpu_core m68ki_cpu = {0};
 
 #if M68K_EMULATE_ADDRESS_ERROR
 #ifdef _BSD_SETJMP_H
-sigjmp_buf m68ki_aerr_trap;
+M68K_THREAD_LOCAL sigjmp_buf m68ki_aerr_trap;
 #else
-jmp_buf m68ki_aerr_trap;
+M68K_THREAD_LOCAL jmp_buf m68ki_aerr_trap;
 #endif
 #endif /* M68K_EMULATE_ADDRESS_ERROR */
 
-uint    m68ki_aerr_address;
-uint    m68ki_aerr_write_mode;
-uint    m68ki_aerr_fc;
+M68K_THREAD_LOCAL uint    m68ki_aerr_address;
+M68K_THREAD_LOCAL uint    m68ki_aerr_write_mode;
+M68K_THREAD_LOCAL uint    m68ki_aerr_fc;
 
-jmp_buf m68ki_bus_error_jmp_buf;
+M68K_THREAD_LOCAL jmp_buf m68ki_bus_error_jmp_buf;
 
 /* Used by shift & rotate instructions */
 const uint8 m68ki_shift_8_table[65] =
@@ -534,7 +537,7 @@ const uint8 m68ki_ea_idx_cycle_table[64] =
  */
 
 /* Interrupt acknowledge */
-static int default_int_ack_callback_data;
+static M68K_THREAD_LOCAL int default_int_ack_callback_data;
 static int default_int_ack_callback(int int_level)
 {
 	default_int_ack_callback_data = int_level;
@@ -543,7 +546,7 @@ static int default_int_ack_callback(int int_level)
 }
 
 /* Breakpoint acknowledge */
-static unsigned int default_bkpt_ack_callback_data;
+static M68K_THREAD_LOCAL unsigned int default_bkpt_ack_callback_data;
 static void default_bkpt_ack_callback(unsigned int data)
 {
 	default_bkpt_ack_callback_data = data;
@@ -580,14 +583,14 @@ static int default_illg_instr_callback(int opcode)
 }
 
 /* Called when the program counter changed by a large value */
-static unsigned int default_pc_changed_callback_data;
+static M68K_THREAD_LOCAL unsigned int default_pc_changed_callback_data;
 static void default_pc_changed_callback(unsigned int new_pc)
 {
 	default_pc_changed_callback_data = new_pc;
 }
 
 /* Called every time there's bus activity (read/write to/from memory */
-static unsigned int default_set_fc_callback_data;
+static M68K_THREAD_LOCAL unsigned int default_set_fc_callback_data;
 static void default_set_fc_callback(unsigned int new_fc)
 {
 	default_set_fc_callback_data = new_fc;
@@ -599,6 +602,188 @@ static void default_instr_hook_callback(unsigned int pc)
 	(void)pc;
 }
 
+/* Called prior to execution, never breaks */
+static int default_breakpoint_callback(unsigned int pc)
+{
+	(void)pc;
+	return 0;
+}
+
+/* Called before a move.b d0,d0 instruction is executed, never breaks */
+static int default_moved0d0_instr_callback(unsigned int pc)
+{
+	(void)pc;
+	return 0;
+}
+
+/* Called when the PC leaves the fetch block, no host memory */
+static const unsigned char *default_fetch_pointer_callback(unsigned int address, unsigned int *start, unsigned int *size)
+{
+	(void)address;
+	*start = *size = 0;
+	return NULL;
+}
+
+/* Called for MOVE16 and copy or fill loops, no host memory */
+static unsigned char *default_host_pointer_callback(unsigned int address, unsigned int size, int write)
+{
+	(void)address;
+	(void)size;
+	(void)write;
+	return NULL;
+}
+
+
+#if M68K_BLOCK_MOVE
+/* Host memory for size bytes at address, NULL if it has to go through the
+ * memory handlers.
+ */
+static unsigned char *m68ki_block_host(uint address, uint size, int write)
+{
+#if M68K_EMULATE_FC
+	return NULL;
+#endif
+#if M68K_EMULATE_PMMU
+	if (PMMU_ENABLED)
+		return NULL;
+#endif
+	return m68ki_host_pointer_callback(ADDRESS_68K(address), size, write);
+}
+
+/* A DBRA has just branched back to the instruction in front of it.  If that
+ * is a move or clr to (Ax)+ from (Ay)+, Dy or zero, go round again as many
+ * times as fit in the timeslice with one memmove or memset.  The last time
+ * round is left to the handlers, so the DBRA that falls out of the loop, and
+ * the instruction the timeslice ends at, run as usual.
+ */
+void m68ki_block_move_loop(uint* r_counter)
+{
+	uint ir = m68k_read_immediate_16(ADDRESS_68K(REG_PC));
+	uint* r_dst = &REG_A[(ir >> 9) & 7];
+	uint* r_src = NULL;
+	uint size = 0, value = 0, count, bytes, per, i;
+	int left;
+	unsigned char* src = NULL;
+	unsigned char* dst;
+
+#if M68K_INSTRUCTION_HOOK || M68K_EMULATE_PREFETCH
+	return;
+#endif
+#if M68K_EMULATE_PMMU
+	if(PMMU_ENABLED)                     /* Host memory is by physical address */
+		return;
+#endif
+#if M68K_EMULATE_TRACE
+	if(FLAG_T1 | FLAG_T0)
+		return;
+#endif
+#if M68K_BREAKPOINT_HOOK == OPT_SPECIFY_HANDLER
+	if(M68K_BREAKPOINT_PAGE(REG_PC) || M68K_BREAKPOINT_PAGE(REG_PC + 2))
+		return;
+#elif M68K_BREAKPOINT_HOOK
+	return;
+#endif
+
+	switch(ir & 0xf1f8)
+	{
+		case 0x10d8: case 0x30d8: case 0x20d8:   /* move (Ay)+, (Ax)+ */
+			r_src = &REG_A[ir & 7];
+			break;
+		case 0x10c0: case 0x30c0: case 0x20c0:   /* move Dy, (Ax)+ */
+			if(&REG_D[ir & 7] == r_counter)
+				return;
+			value = REG_D[ir & 7];
+			break;
+		default:
+			if((ir & 0xfff8) != 0x4218 && (ir & 0xfff8) != 0x4258 && (ir & 0xfff8) != 0x4298)
+				return;                          /* clr (Ay)+ */
+			r_dst = &REG_A[ir & 7];
+			size = 1 << ((ir >> 6) & 3);
+			break;
+	}
+	if(ir & 0x2000)
+		size = (ir & 0x1000) ? 2 : 4;
+	else if(ir & 0x1000)
+		size = 1;
+	if(r_dst == &REG_A[7] || r_src == &REG_A[7] || r_src == r_dst)
+		return;                                  /* A7 steps by 2 for bytes */
+#if M68K_EMULATE_ADDRESS_ERROR
+	if(CPU_TYPE_IS_010_LESS(CPU_TYPE) && size > 1 && ((*r_dst | (r_src ? *r_src : 0)) & 1))
+		return;
+#endif
+
+	/* Stop one cycle short, so the timeslice ends where it would have */
+	per = CYC_INSTRUCTION[ir] + CYC_INSTRUCTION[REG_IR] + CYC_DBCC_F_NOEXP;
+	left = GET_CYCLES() - (int)CYC_INSTRUCTION[REG_IR];
+	if(left <= 1 || per == 0)
+		return;
+	count = MASK_OUT_ABOVE_16(*r_counter);
+	if(count > (uint)(left - 1) / per)
+		count = (uint)(left - 1) / per;
+	if(count == 0)
+		return;
+	bytes = count * size;
+	if(*r_dst < REG_PC + 6 && *r_dst + bytes > REG_PC)
+		return;                                  /* Writes over the move or the DBRA after it */
+
+	if(r_src != NULL)
+	{
+		src = m68ki_block_host(*r_src, bytes, 0);
+		if(src == NULL)
+			return;
+	}
+	dst = m68ki_block_host(*r_dst, bytes, 1);
+	if(dst == NULL)
+		return;
+	if(src != NULL)
+	{
+		if(dst > src && dst < src + bytes)
+			return;                              /* Would copy its own output */
+		memmove(dst, src, bytes);
+		*r_src += bytes;
+	}
+	else if(size == 1)
+		memset(dst, value, bytes);
+	else
+		for(i = 0; i < bytes; i++)
+			dst[i] = value >> (8 * (size - 1 - (i & (size - 1))));
+
+	/* Flags from the last one moved */
+	for(value = 0, i = bytes - size; i < bytes; i++)
+		value = (value << 8) | dst[i];
+	if(size == 1)
+		FLAG_N = NFLAG_8(value);
+	else if(size == 2)
+		FLAG_N = NFLAG_16(value);
+	else
+		FLAG_N = NFLAG_32(value);
+	FLAG_Z = value;
+	FLAG_V = VFLAG_CLEAR;
+	FLAG_C = CFLAG_CLEAR;
+
+	m68ki_count_write(*r_dst); /* auto-disable (see m68kcpu.h) */
+	*r_dst += bytes;
+	*r_counter = MASK_OUT_BELOW_16(*r_counter) | (MASK_OUT_ABOVE_16(*r_counter) - count);
+	USE_CYCLES(count * per);
+}
+
+/* MOVE16 as one memmove, returns 0 if either line is not plain memory */
+int m68ki_block_move16(uint src, uint dst)
+{
+	unsigned char* from = m68ki_block_host(src, 16, 0);
+	unsigned char* to;
+
+	if(from == NULL)
+		return 0;
+	to = m68ki_block_host(dst, 16, 1);
+	if(to == NULL || (to > from && to < from + 16))
+		return 0;
+	memmove(to, from, 16);
+	m68ki_count_write(dst); /* auto-disable (see m68kcpu.h) */
+	return 1;
+}
+#endif /* M68K_BLOCK_MOVE */
+
 
 #if M68K_EMULATE_ADDRESS_ERROR
 	#include <setjmp.h>
@@ -776,16 +961,97 @@ void m68k_set_instr_hook_callback(void  (*callback)(unsigned int pc))
 	CALLBACK_INSTR_HOOK = callback ? callback : default_instr_hook_callback;
 }
 
+void m68k_set_breakpoint_callback(int  (*callback)(unsigned int pc))
+{
+	CALLBACK_BREAKPOINT = callback ? callback : default_breakpoint_callback;
+}
+
+void m68k_set_moved0d0_instr_callback(int  (*callback)(unsigned int pc))
+{
+	CALLBACK_MOVED0D0_INSTR = callback ? callback : default_moved0d0_instr_callback;
+}
+
+void m68k_set_fetch_pointer_callback(const unsigned char *(*callback)(unsigned int address,unsigned int *start,unsigned int *size))
+{
+	CALLBACK_FETCH_POINTER = callback ? callback : default_fetch_pointer_callback;
+	m68k_flush_fetch_pointer();
+}
+
+void m68k_set_host_pointer_callback(unsigned char *(*callback)(unsigned int address,unsigned int size,int write))
+{
+	CALLBACK_HOST_POINTER = callback ? callback : default_host_pointer_callback;
+}
+
+void m68k_flush_fetch_pointer(void)
+{
+	CPU_FETCH_LIMIT16 = CPU_FETCH_LIMIT32 = 0;
+}
+
+/* Get host memory for the block holding address, used by m68ki_read_imm_16() */
+void m68ki_fetch_refresh(uint address)
+{
+#if M68K_FETCH_POINTER
+	uint start, size;
+	const unsigned char *host;
+
+	m68k_flush_fetch_pointer();
+#if M68K_EMULATE_PMMU
+	if (PMMU_ENABLED)
+		return;
+#endif
+	host = m68ki_fetch_pointer_callback(address, &start, &size);
+	if(host == NULL || size < 4)
+		return;
+	CPU_FETCH_HOST = host;
+	CPU_FETCH_START = start;
+	CPU_FETCH_LIMIT16 = size - 1;
+	CPU_FETCH_LIMIT32 = size - 3;
+#else
+	(void)address;
+#endif /* M68K_FETCH_POINTER */
+}
+
 /* Set the CPU type. */
+#ifdef M68KOPS_ONLY_CPU
+/* Column of the cycle tables used by a CPU type */
+static int m68ki_cpu_cycle_column(unsigned int cpu_type)
+{
+	switch(cpu_type)
+	{
+		case M68K_CPU_TYPE_68000:
+			return 0;
+		case M68K_CPU_TYPE_68010:
+		case M68K_CPU_TYPE_SCC68070:
+			return 1;
+		case M68K_CPU_TYPE_68EC020:
+		case M68K_CPU_TYPE_68020:
+			return 2;
+		case M68K_CPU_TYPE_68EC030:
+		case M68K_CPU_TYPE_68030:
+			return 3;
+		case M68K_CPU_TYPE_68EC040:
+		case M68K_CPU_TYPE_68LC040:
+		case M68K_CPU_TYPE_68040:
+			return 4;
+	}
+	return -1;
+}
+#endif
+
 void m68k_set_cpu_type(unsigned int cpu_type)
 {
+#ifdef M68KOPS_ONLY_CPU
+	if(m68ki_cpu_cycle_column(cpu_type) != M68KOPS_ONLY_CPU)
+		return;  /* The opcode tables were only generated for one CPU type */
+#endif
+	m68k_flush_code_cache(); /* Cached cycle counts are for the old CPU */
 	switch(cpu_type)
 	{
 		case M68K_CPU_TYPE_68000:
 			CPU_TYPE         = CPU_TYPE_000;
 			CPU_ADDRESS_MASK = 0x00ffffff;
 			CPU_SR_MASK      = 0xa71f; /* T1 -- S  -- -- I2 I1 I0 -- -- -- X  N  Z  V  C  */
-			CYC_INSTRUCTION  = m68ki_cycles[0];
+			CYC_INSTRUCTION  = m68ki_cycles[m68ki_cycle_column(0)];
 			CYC_EXCEPTION    = m68ki_exception_cycle_table[0];
 			CYC_BCC_NOTAKE_B = -2;
 			CYC_BCC_NOTAKE_W = 2;
@@ -807,7 +1073,7 @@ void m68k_set_cpu_type(unsigned int cpu_type)
 			CPU_TYPE         = CPU_TYPE_010;
 			CPU_ADDRESS_MASK = 0x00ffffff;
 			CPU_SR_MASK      = 0xa71f; /* T1 -- S  -- -- I2 I1 I0 -- -- -- X  N  Z  V  C  */
-			CYC_INSTRUCTION  = m68ki_cycles[1];
+			CYC_INSTRUCTION  = m68ki_cycles[m68ki_cycle_column(1)];
 			CYC_EXCEPTION    = m68ki_exception_cycle_table[1];
 			CYC_BCC_NOTAKE_B = -4;
 			CYC_BCC_NOTAKE_W = 0;
@@ -824,7 +1090,7 @@ void m68k_set_cpu_type(unsigned int cpu_type)
 			CPU_TYPE         = CPU_TYPE_EC020;
 			CPU_ADDRESS_MASK = 0x00ffffff;
 			CPU_SR_MASK      = 0xf71f; /* T1 T0 S  M  -- I2 I1 I0 -- -- -- X  N  Z  V  C  */
-			CYC_INSTRUCTION  = m68ki_cycles[2];
+			CYC_INSTRUCTION  = m68ki_cycles[m68ki_cycle_column(2)];
 			CYC_EXCEPTION    = m68ki_exception_cycle_table[2];
 			CYC_BCC_NOTAKE_B = -2;
 			CYC_BCC_NOTAKE_W = 0;
@@ -841,7 +1107,7 @@ void m68k_set_cpu_type(unsigned int cpu_type)
 			CPU_TYPE         = CPU_TYPE_020;
 			CPU_ADDRESS_MASK = 0xffffffff;
 			CPU_SR_MASK      = 0xf71f; /* T1 T0 S  M  -- I2 I1 I0 -- -- -- X  N  Z  V  C  */
-			CYC_INSTRUCTION  = m68ki_cycles[2];
+			CYC_INSTRUCTION  = m68ki_cycles[m68ki_cycle_column(2)];
 			CYC_EXCEPTION    = m68ki_exception_cycle_table[2];
 			CYC_BCC_NOTAKE_B = -2;
 			CYC_BCC_NOTAKE_W = 0;
@@ -858,7 +1124,7 @@ void m68k_set_cpu_type(unsigned int cpu_type)
 			CPU_TYPE         = CPU_TYPE_030;
 			CPU_ADDRESS_MASK = 0xffffffff;
 			CPU_SR_MASK      = 0xf71f; /* T1 T0 S  M  -- I2 I1 I0 -- -- -- X  N  Z  V  C  */
-			CYC_INSTRUCTION  = m68ki_cycles[3];
+			CYC_INSTRUCTION  = m68ki_cycles[m68ki_cycle_column(3)];
 			CYC_EXCEPTION    = m68ki_exception_cycle_table[3];
 			CYC_BCC_NOTAKE_B = -2;
 			CYC_BCC_NOTAKE_W = 0;
@@ -875,7 +1141,7 @@ void m68k_set_cpu_type(unsigned int cpu_type)
 			CPU_TYPE         = CPU_TYPE_EC030;
 			CPU_ADDRESS_MASK = 0xffffffff;
 			CPU_SR_MASK          = 0xf71f; /* T1 T0 S  M  -- I2 I1 I0 -- -- -- X  N  Z  V  C  */
-			CYC_INSTRUCTION  = m68ki_cycles[3];
+			CYC_INSTRUCTION  = m68ki_cycles[m68ki_cycle_column(3)];
 			CYC_EXCEPTION    = m68ki_exception_cycle_table[3];
 			CYC_BCC_NOTAKE_B = -2;
 			CYC_BCC_NOTAKE_W = 0;
@@ -892,7 +1158,7 @@ void m68k_set_cpu_type(unsigned int cpu_type)
 			CPU_TYPE         = CPU_TYPE_040;
 			CPU_ADDRESS_MASK = 0xffffffff;
 			CPU_SR_MASK      = 0xf71f; /* T1 T0 S  M  -- I2 I1 I0 -- -- -- X  N  Z  V  C  */
-			CYC_INSTRUCTION  = m68ki_cycles[4];
+			CYC_INSTRUCTION  = m68ki_cycles[m68ki_cycle_column(4)];
 			CYC_EXCEPTION    = m68ki_exception_cycle_table[4];
 			CYC_BCC_NOTAKE_B = -2;
 			CYC_BCC_NOTAKE_W = 0;
@@ -909,7 +1175,7 @@ void m68k_set_cpu_type(unsigned int cpu_type)
 			CPU_TYPE         = CPU_TYPE_EC040;
 			CPU_ADDRESS_MASK = 0xffffffff;
 			CPU_SR_MASK      = 0xf71f; /* T1 T0 S  M  -- I2 I1 I0 -- -- -- X  N  Z  V  C  */
-			CYC_INSTRUCTION  = m68ki_cycles[4];
+			CYC_INSTRUCTION  = m68ki_cycles[m68ki_cycle_column(4)];
 			CYC_EXCEPTION    = m68ki_exception_cycle_table[4];
 			CYC_BCC_NOTAKE_B = -2;
 			CYC_BCC_NOTAKE_W = 0;
@@ -925,7 +1191,7 @@ void m68k_set_cpu_type(unsigned int cpu_type)
 		case M68K_CPU_TYPE_68LC040:
 			CPU_TYPE         = CPU_TYPE_LC040;
 			m68ki_cpu.sr_mask          = 0xf71f; /* T1 T0 S  M  -- I2 I1 I0 -- -- -- X  N  Z  V  C  */
-			m68ki_cpu.cyc_instruction  = m68ki_cycles[4];
+			m68ki_cpu.cyc_instruction  = m68ki_cycles[m68ki_cycle_column(4)];
 			m68ki_cpu.cyc_exception    = m68ki_exception_cycle_table[4];
 			m68ki_cpu.cyc_bcc_notake_b = -2;
 			m68ki_cpu.cyc_bcc_notake_w = 0;
@@ -945,9 +1211,11 @@ void m68k_set_cpu_type(unsigned int cpu_type)
 /* ASG: removed per-instruction interrupt checks */
 int m68k_execute(int num_cycles)
 {
+	volatile int rc = 0; /* Kept over the bus error longjmp */
+
 	/* eat up any reset cycles */
 	if (RESET_CYCLES) {
-	    int rc = RESET_CYCLES;
+	    rc = RESET_CYCLES;
 	    RESET_CYCLES = 0;
 	    num_cycles -= rc;
 	    if (num_cycles <= 0)
@@ -972,13 +1240,71 @@ int m68k_execute(int num_cycles)
 		/* Main loop.  Keep going until we run out of clock cycles */
 		do
 		{
-			int i;
+#if M68K_BLOCK_CACHE
+			m68ki_block *block = m68ki_block_lookup(REG_PC);
+			if(block != NULL)
+			{
+#if M68K_IDLE_LOOP
+				/* Polling, nothing will change until the next event.  Not
+				 * when asked for a single instruction.
+				 */
+				if(GET_CYCLES() > 0 && m68ki_idle_loop(block))
+				{
+					SET_CYCLES(0);
+					break;
+				}
+#endif
+				/* Replay a block while the PC follows the recorded path */
+				m68ki_block_entry *e = block->entry;
+				m68ki_block_entry *end = e + block->length;
+#if M68KI_JIT
+				if(block->code == NULL && m68ki_jit_enabled && ++block->hits == M68K_JIT_THRESHOLD)
+					m68ki_jit_compile(block);
+				if(block->code != NULL && !m68ki_jit_breakpoint(block))
+				{
+					block->code();
+					continue;
+				}
+#endif
+				do
+				{
+					if(REG_PC != e->pc)
+						break;
+#if M68K_EMULATE_TRACE
+					if(FLAG_T1)
+						break;
+#endif
+					m68ki_use_data_space(); /* auto-disable (see m68kcpu.h) */
+					if(m68ki_breakpoint_hook(REG_PC)) /* auto-disable (see m68kcpu.h) */
+					{
+						m68k_end_timeslice();
+						break;
+					}
+					m68ki_instr_hook(REG_PC); /* auto-disable (see m68kcpu.h) */
+					REG_PPC = REG_PC;
+					m68ki_save_da(); /* auto-disable (see m68kcpu.h) */
+					REG_IR = e->ir;
+					REG_PC += 2;
+					e->handler();
+					USE_CYCLES(e->cycles);
+				} while(++e < end && GET_CYCLES() > 0);
+				continue;
+			}
+#endif /* M68K_BLOCK_CACHE */
+
 			/* Set tracing accodring to T1. (T0 is done inside instruction) */
 			m68ki_trace_t1(); /* auto-disable (see m68kcpu.h) */
 
 			/* Set the address space for reads */
 			m68ki_use_data_space(); /* auto-disable (see m68kcpu.h) */
 
+			/* Stop before this instruction if the host asks us to */
+			if(m68ki_breakpoint_hook(REG_PC)) /* auto-disable (see m68kcpu.h) */
+			{
+				m68k_end_timeslice();
+				break;
+			}
+
 			/* Call external hook to peek at CPU */
 			m68ki_instr_hook(REG_PC); /* auto-disable (see m68kcpu.h) */
 
@@ -986,27 +1312,32 @@ int m68k_execute(int num_cycles)
 			REG_PPC = REG_PC;
 
 			/* Record previous D/A register state (in case of bus error) */
-			for (i = 15; i >= 0; i--){
-				REG_DA_SAVE[i] = REG_DA[i];
-			}
+			m68ki_save_da(); /* auto-disable (see m68kcpu.h) */
 
 			/* Read an instruction and call its handler */
 			REG_IR = m68ki_read_imm_16();
-			m68ki_instruction_jump_table[REG_IR]();
+#if M68K_BLOCK_CACHE
+			m68ki_block_record(REG_PPC);
+#endif
+			m68ki_instruction_handler(REG_IR)();
 			USE_CYCLES(CYC_INSTRUCTION[REG_IR]);
 
 			/* Trace m68k_exception, if necessary */
 			m68ki_exception_if_trace(); /* auto-disable (see m68kcpu.h) */
 		} while(GET_CYCLES() > 0);
 
+#if M68K_BLOCK_CACHE
+		m68ki_block_end_record();
+#endif
+
 		/* set previous PC to current PC for the next entry into the loop */
 		REG_PPC = REG_PC;
 	}
 	else
 		SET_CYCLES(0);
 
-	/* return how many clocks we used */
-	return m68ki_initial_cycles - GET_CYCLES();
+	/* return how many clocks we used, including any reset cycles */
+	return m68ki_initial_cycles - GET_CYCLES() + rc;
 }
 
 
@@ -1030,7 +1361,7 @@ void m68k_modify_timeslice(int cycles)
 
 void m68k_end_timeslice(void)
 {
-	m68ki_initial_cycles = GET_CYCLES();
+	m68ki_initial_cycles -= GET_CYCLES();
 	SET_CYCLES(0);
 }
 
@@ -1074,14 +1405,22 @@ unsigned int m68k_get_virq(unsigned int level)
 
 void m68k_init(void)
 {
+#if M68K_PER_THREAD && !defined(_MSC_VER)
+	/* The opcode handler jump table is shared, so only one thread builds it */
+	static pthread_once_t table_once = PTHREAD_ONCE_INIT;
+
+	pthread_once(&table_once, m68ki_build_opcode_table);
+#else
 	static uint emulation_initialized = 0;
 
 	/* The first call to this function initializes the opcode handler jump table */
 	if(!emulation_initialized)
-		{
+	{
 		m68ki_build_opcode_table();
 		emulation_initialized = 1;
 	}
+#endif
+	m68k_flush_code_cache();   /* This thread's blocks */
 
 	m68k_set_int_ack_callback(NULL);
 	m68k_set_bkpt_ack_callback(NULL);
@@ -1093,6 +1432,10 @@ void m68k_init(void)
 	m68k_set_pc_changed_callback(NULL);
 	m68k_set_fc_callback(NULL);
 	m68k_set_instr_hook_callback(NULL);
+	m68k_set_breakpoint_callback(NULL);
+	m68k_set_moved0d0_instr_callback(NULL);
+	m68k_set_fetch_pointer_callback(NULL);
+	m68k_set_host_pointer_callback(NULL);
 }
 
 /* Trigger a Bus Error exception */
@@ -1106,6 +1449,12 @@ void m68k_pulse_reset(void)
 {
 	/* Disable the PMMU on reset */
 	m68ki_cpu.pmmu_enabled = 0;
+	m68ki_cpu.mmu_tc = 0;
+	m68ki_cpu.mmu_page_mask = 0xfffff000;
+	memset(m68ki_cpu.mmu_tt, 0, sizeof(m68ki_cpu.mmu_tt));
+	memset(m68ki_cpu.mmu_atc, 0, sizeof(m68ki_cpu.mmu_atc));
+	m68k_flush_fetch_pointer();
+	m68k_flush_code_cache();
 
 	/* Clear all stop levels and eat up all remaining cycles */
 	CPU_STOPPED = 0;
@@ -1165,6 +1514,42 @@ unsigned int m68k_get_context(void* dst)
 void m68k_set_context(void* src)
 {
 	if(src) m68ki_cpu = *(m68ki_cpu_core*)src;
+	m68k_flush_fetch_pointer();
+	m68k_flush_code_cache();
+}
+
+/* The state is the context up to the first host pointer, cyc_instruction.
+ * The fetch pointer before it is host memory too, so it is saved as zero and
+ * set up again when the state is loaded, through m68k_set_context().
+ */
+#define M68K_STATE_SIZE ((unsigned int)offsetof(m68ki_cpu_core, cyc_instruction))
+#define M68K_STATE_FETCH offsetof(m68ki_cpu_core, fetch_host)
+#define M68K_STATE_FETCH_SIZE (offsetof(m68ki_cpu_core, address_mask) - M68K_STATE_FETCH)
+
+unsigned int m68k_state_size(void)
+{
+	return M68K_STATE_SIZE;
+}
+
+unsigned int m68k_get_state(void* dst)
+{
+	if(dst)
+	{
+		memcpy(dst, &m68ki_cpu, M68K_STATE_SIZE);
+		memset((char*)dst + M68K_STATE_FETCH, 0, M68K_STATE_FETCH_SIZE);
+	}
+	return M68K_STATE_SIZE;
+}
+
+int m68k_set_state(const void* src)
+{
+	m68ki_cpu_core context = m68ki_cpu;   /* Keeps the host pointers */
+
+	if(((const m68ki_cpu_core*)src)->cpu_type != CPU_TYPE)
+		return 0;  /* Cycle tables are for another CPU */
+	memcpy(&context, src, M68K_STATE_SIZE);
+	m68k_set_context(&context);
+	return 1;
 }
 
 /* ======================================================================== */
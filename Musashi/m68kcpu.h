@@ -38,10 +38,13 @@ extern "C" {
 #endif
 
 #include "m68k.h"
+#include "m68kops.h"
 
 #include <limits.h>
 
 #include <setjmp.h>
+#include <stddef.h>
+#include <string.h>
 
 /* ======================================================================== */
 /* ==================== ARCHITECTURE-DEPENDANT DEFINES ==================== */
@@ -365,6 +368,10 @@ typedef uint32 uint64;
 #define CPU_STOPPED      m68ki_cpu.stopped
 #define CPU_PREF_ADDR    m68ki_cpu.pref_addr
 #define CPU_PREF_DATA    m68ki_cpu.pref_data
+#define CPU_FETCH_HOST   m68ki_cpu.fetch_host
+#define CPU_FETCH_START  m68ki_cpu.fetch_start
+#define CPU_FETCH_LIMIT16 m68ki_cpu.fetch_limit16
+#define CPU_FETCH_LIMIT32 m68ki_cpu.fetch_limit32
 #define CPU_ADDRESS_MASK m68ki_cpu.address_mask
 #define CPU_SR_MASK      m68ki_cpu.sr_mask
 #define CPU_INSTR_MODE   m68ki_cpu.instr_mode
@@ -396,6 +403,10 @@ typedef uint32 uint64;
 #define CALLBACK_PC_CHANGED  m68ki_cpu.pc_changed_callback
 #define CALLBACK_SET_FC      m68ki_cpu.set_fc_callback
 #define CALLBACK_INSTR_HOOK  m68ki_cpu.instr_hook_callback
+#define CALLBACK_BREAKPOINT  m68ki_cpu.breakpoint_callback
+#define CALLBACK_MOVED0D0_INSTR m68ki_cpu.moved0d0_instr_callback
+#define CALLBACK_FETCH_POINTER m68ki_cpu.fetch_pointer_callback
+#define CALLBACK_HOST_POINTER m68ki_cpu.host_pointer_callback
 
 
 
@@ -403,6 +414,23 @@ typedef uint32 uint64;
 
 /* These defines are dependant on the configuration defines in m68kconf.h */
 
+/* A core generated with m68kmake -cpu=040 only runs the 68040 family */
+#if defined(M68KOPS_ONLY_CPU) && M68KOPS_ONLY_CPU == 4
+#define CPU_TYPE_IS_040_PLUS(A)    1
+#define CPU_TYPE_IS_040_LESS(A)    1
+#define CPU_TYPE_IS_030_PLUS(A)    1
+#define CPU_TYPE_IS_030_LESS(A)    1
+#define CPU_TYPE_IS_020_PLUS(A)    1
+#define CPU_TYPE_IS_020_LESS(A)    1
+#define CPU_TYPE_IS_EC020_PLUS(A)  1
+#define CPU_TYPE_IS_EC020_LESS(A)  0
+#define CPU_TYPE_IS_010(A)         0
+#define CPU_TYPE_IS_010_PLUS(A)    1
+#define CPU_TYPE_IS_010_LESS(A)    0
+#define CPU_TYPE_IS_020_VARIANT(A) 0
+#define CPU_TYPE_IS_000(A)         0
+#else
+
 /* Disable certain comparisons if we're not using all CPU types */
 #if M68K_EMULATE_040
 #define CPU_TYPE_IS_040_PLUS(A)    ((A) & (CPU_TYPE_040 | CPU_TYPE_EC040))
@@ -458,6 +486,8 @@ typedef uint32 uint64;
 	#define CPU_TYPE_IS_000(A)         1
 #endif
 
+#endif /* M68KOPS_ONLY_CPU */
+
 
 #if !M68K_SEPARATE_READS
 #define m68k_read_immediate_16(A) m68ki_read_program_16(A)
@@ -551,6 +581,42 @@ typedef uint32 uint64;
 	#define m68ki_instr_hook(pc)
 #endif /* M68K_INSTRUCTION_HOOK */
 
+#if M68K_BREAKPOINT_HOOK
+	#if M68K_BREAKPOINT_HOOK == OPT_SPECIFY_HANDLER
+		#define m68ki_breakpoint_hook(pc) (M68K_BREAKPOINT_PAGE(pc) && M68K_BREAKPOINT_CALLBACK(pc))
+	#else
+		#define m68ki_breakpoint_hook(pc) CALLBACK_BREAKPOINT(pc)
+	#endif
+#else
+	#define m68ki_breakpoint_hook(pc) 0
+#endif /* M68K_BREAKPOINT_HOOK */
+
+#if M68K_MOVED0D0_HAS_CALLBACK
+	#if M68K_MOVED0D0_HAS_CALLBACK == OPT_SPECIFY_HANDLER
+		#define m68ki_moved0d0_callback(pc) M68K_MOVED0D0_CALLBACK(pc)
+	#else
+		#define m68ki_moved0d0_callback(pc) CALLBACK_MOVED0D0_INSTR(pc)
+	#endif
+#else
+	#define m68ki_moved0d0_callback(pc) 0
+#endif /* M68K_MOVED0D0_HAS_CALLBACK */
+
+#if M68K_FETCH_POINTER
+	#if M68K_FETCH_POINTER == OPT_SPECIFY_HANDLER
+		#define m68ki_fetch_pointer_callback(A,S,L) M68K_FETCH_POINTER_CALLBACK(A,S,L)
+	#else
+		#define m68ki_fetch_pointer_callback(A,S,L) CALLBACK_FETCH_POINTER(A,S,L)
+	#endif
+#endif /* M68K_FETCH_POINTER */
+
+#if M68K_BLOCK_MOVE
+	#if M68K_BLOCK_MOVE == OPT_SPECIFY_HANDLER
+		#define m68ki_host_pointer_callback(A,S,W) M68K_BLOCK_MOVE_CALLBACK(A,S,W)
+	#else
+		#define m68ki_host_pointer_callback(A,S,W) CALLBACK_HOST_POINTER(A,S,W)
+	#endif
+#endif /* M68K_BLOCK_MOVE */
+
 #if M68K_MONITOR_PC
 	#if M68K_MONITOR_PC == OPT_SPECIFY_HANDLER
 		#define m68ki_pc_changed(A) M68K_SET_PC_CALLBACK(ADDRESS_68K(A))
@@ -579,6 +645,31 @@ typedef uint32 uint64;
 	#define m68ki_get_address_space() FUNCTION_CODE_USER_DATA
 #endif /* M68K_EMULATE_FC */
 
+/* Record the D/A registers before each instruction, so a bus error can undo
+ * the changes the instruction made to them.
+ */
+#if M68K_EMULATE_BUS_ERROR
+	#define m68ki_save_da() memcpy(REG_DA_SAVE, REG_DA, sizeof(REG_DA))
+#elif M68K_EMULATE_PMMU
+	/* Only needed to restart an instruction after a PMMU fault */
+	#define m68ki_save_da() do { if(PMMU_ENABLED) memcpy(REG_DA_SAVE, REG_DA, sizeof(REG_DA)); } while(0)
+#else
+	#define m68ki_save_da()
+#endif /* M68K_EMULATE_BUS_ERROR */
+
+/* Count memory writes, so a loop can be seen not to have made any.  Writes
+ * to the stack around the SP of the loop being watched don't count, that
+ * is checked separately (m68kblock.h).
+ */
+#if M68K_IDLE_LOOP
+	#define M68K_IDLE_STACK_BYTES 4096   /* Dead stack below the SP */
+	#define M68K_IDLE_FRAME_BYTES 64     /* Live stack above it */
+	#define m68ki_count_write(A) \
+		if((A) - m68ki_cpu.idle_stack >= M68K_IDLE_STACK_BYTES + M68K_IDLE_FRAME_BYTES) m68ki_cpu.writes++
+#else
+	#define m68ki_count_write(A)
+#endif /* M68K_IDLE_LOOP */
+
 
 /* Enable or disable trace emulation */
 #if M68K_EMULATE_TRACE
@@ -605,7 +696,7 @@ typedef uint32 uint64;
 
 /* sigjmp() on Mac OS X and *BSD in general saves signal contexts and is super-slow, use sigsetjmp() to tell it not to */
 #ifdef _BSD_SETJMP_H
-extern sigjmp_buf m68ki_aerr_trap;
+extern M68K_THREAD_LOCAL sigjmp_buf m68ki_aerr_trap;
 #define m68ki_set_address_error_trap(m68k) \
 	if(sigsetjmp(m68ki_aerr_trap, 0) != 0) \
 	{ \
@@ -627,7 +718,7 @@ extern sigjmp_buf m68ki_aerr_trap;
 		siglongjmp(m68ki_aerr_trap, 1); \
 	}
 #else
-extern jmp_buf m68ki_aerr_trap;
+extern M68K_THREAD_LOCAL jmp_buf m68ki_aerr_trap;
 	#define m68ki_set_address_error_trap() \
 		if(setjmp(m68ki_aerr_trap) != 0) \
 		{ \
@@ -923,6 +1014,18 @@ typedef union
 	double f;
 } fp_reg;
 
+/* One entry of the 68040 MMU's address translation cache, a direct mapped
+ * software TLB in front of the table walk (m68kmmu.h).
+ */
+#define M68K_MMU_ATC_SIZE 256
+
+typedef struct
+{
+	uint logical;      /* Logical page | S << 1 | 1, 0 if empty */
+	uint physical;     /* Physical page */
+	uint write;        /* Non zero if writes can use it, W clear and M set */
+} m68ki_mmu_atc;
+
 typedef struct
 {
 	uint cpu_type;     /* CPU Type: 68000, 68008, 68010, 68EC020, 68020, 68EC030, 68030, 68EC040, or 68040 */
@@ -956,6 +1059,10 @@ typedef struct
 	uint stopped;      /* Stopped state */
 	uint pref_addr;    /* Last prefetch address */
 	uint pref_data;    /* Data in the prefetch queue */
+	const uint8* fetch_host; /* Host memory for instruction fetch, at fetch_start */
+	uint fetch_start;  /* First address in fetch_host */
+	uint fetch_limit16; /* Word fetch is direct if PC-fetch_start is below this */
+	uint fetch_limit32; /* Long fetch is direct if PC-fetch_start is below this */
 	uint address_mask; /* Available address pins */
 	uint sr_mask;      /* Implemented status register bits */
 	uint instr_mode;   /* Stores whether we are in instruction mode or group 0/1 exception mode */
@@ -964,6 +1071,8 @@ typedef struct
 	int    pmmu_enabled; /* Indicates if the PMMU is enabled */
 	int    fpu_just_reset; /* Indicates the FPU was just reset */
 	uint reset_cycles;
+	uint writes;       /* Memory writes, counted if M68K_IDLE_LOOP is on */
+	uint idle_stack;   /* Bottom of the stack whose writes aren't counted */
 
 	/* Clocks required for instructions / exceptions */
 	uint cyc_bcc_notake_b;
@@ -986,6 +1095,13 @@ typedef struct
 	uint mmu_tc;
 	uint16 mmu_sr;
 
+	/* 68040 MMU registers, SRP is mmu_srp_aptr */
+	uint mmu_urp_aptr;
+	uint mmu_tt[4];        /* ITT0, ITT1, DTT0, DTT1 */
+	uint mmu_mmusr;
+	uint mmu_page_mask;    /* ~(page size - 1) */
+	m68ki_mmu_atc mmu_atc[2][M68K_MMU_ATC_SIZE];   /* Data and instruction ATCs */
+
 	const uint8* cyc_instruction;
 	const uint8* cyc_exception;
 
@@ -1000,23 +1116,33 @@ typedef struct
 	void (*pc_changed_callback)(unsigned int new_pc); /* Called when the PC changes by a large amount */
 	void (*set_fc_callback)(unsigned int new_fc);     /* Called when the CPU function code changes */
 	void (*instr_hook_callback)(unsigned int pc);     /* Called every instruction cycle prior to execution */
+	int  (*breakpoint_callback)(unsigned int pc);     /* Called prior to execution, non zero stops before the instruction */
+	int  (*moved0d0_instr_callback)(unsigned int pc); /* Called before a MOVE.B D0,D0 instruction, non zero stops before it */
+	const unsigned char *(*fetch_pointer_callback)(unsigned int, unsigned int*, unsigned int*); /* Host memory for instruction fetch */
+	unsigned char *(*host_pointer_callback)(unsigned int, unsigned int, int); /* Host memory for block moves */
 
 } m68ki_cpu_core;
 
 
-extern m68ki_cpu_core m68ki_cpu;
-extern sint           m68ki_remaining_cycles;
-extern uint           m68ki_tracing;
+extern M68K_THREAD_LOCAL m68ki_cpu_core m68ki_cpu;
+extern M68K_THREAD_LOCAL sint           m68ki_remaining_cycles;
+extern M68K_THREAD_LOCAL uint           m68ki_tracing;
 extern const uint8    m68ki_shift_8_table[];
 extern const uint16   m68ki_shift_16_table[];
 extern const uint     m68ki_shift_32_table[];
 extern const uint8    m68ki_exception_cycle_table[][256];
-extern uint           m68ki_address_space;
+extern M68K_THREAD_LOCAL uint           m68ki_address_space;
 extern const uint8    m68ki_ea_idx_cycle_table[];
 
-extern uint           m68ki_aerr_address;
-extern uint           m68ki_aerr_write_mode;
-extern uint           m68ki_aerr_fc;
+extern M68K_THREAD_LOCAL uint           m68ki_aerr_address;
+extern M68K_THREAD_LOCAL uint           m68ki_aerr_write_mode;
+extern M68K_THREAD_LOCAL uint           m68ki_aerr_fc;
+
+#if M68K_BLOCK_MOVE
+/* MOVE16 and copy or fill loops through host memory (m68kcpu.c) */
+void m68ki_block_move_loop(uint* r_counter);
+int m68ki_block_move16(uint src, uint dst);
+#endif
 
 /* Forward declarations to keep some of the macros happy */
 static inline uint m68ki_read_16_fc (uint address, uint fc);
@@ -1036,6 +1162,36 @@ char* m68ki_disassemble_quick(unsigned int pc, unsigned int cpu_type);
 /* ---------------------------- Read Immediate ---------------------------- */
 
 extern uint pmmu_translate_addr(uint addr_in);
+extern void m68ki_fetch_refresh(uint address);
+extern void m68ki_mmu_pflush(uint address, int all);
+extern void m68ki_mmu_ptest(uint address, uint fc, int write);
+extern void m68ki_mmu_movec(uint reg, uint value);
+
+#if M68K_EMULATE_PMMU
+extern uint m68ki_mmu_walk(uint address, uint fc, int write);
+
+/* Logical to physical address.  A 68040 costs one probe of the translation
+ * cache unless it misses, the 68030 walks the tables every time.
+ */
+static inline uint m68ki_mmu_translate(uint address, uint fc, int write)
+{
+	const m68ki_mmu_atc* atc;
+
+	if(!CPU_TYPE_IS_040_PLUS(CPU_TYPE))
+		return pmmu_translate_addr(address);
+	atc = &m68ki_cpu.mmu_atc[(fc & 3) == FUNCTION_CODE_USER_PROGRAM][(address >> 12) & (M68K_MMU_ATC_SIZE - 1)];
+	if(atc->logical == ((address & m68ki_cpu.mmu_page_mask) | ((fc & 4) >> 1) | 1) && (atc->write || !write))
+		return atc->physical | (address & ~m68ki_cpu.mmu_page_mask);
+	return m68ki_mmu_walk(address, fc, write);
+}
+#endif /* M68K_EMULATE_PMMU */
+
+/* Separate immediate reads don't go through m68ki_read_program_16() */
+#if M68K_EMULATE_PMMU && M68K_SEPARATE_READS
+#define m68ki_mmu_program(A) (PMMU_ENABLED ? m68ki_mmu_translate(A, FLAG_S | FUNCTION_CODE_USER_PROGRAM, 0) : (A))
+#else
+#define m68ki_mmu_program(A) (A)
+#endif
 
 /* Handles all immediate reads, does address error check, function code setting,
  * and prefetching if they are enabled in m68kconf.h
@@ -1045,13 +1201,6 @@ static inline uint m68ki_read_imm_16(void)
 	m68ki_set_fc(FLAG_S | FUNCTION_CODE_USER_PROGRAM); /* auto-disable (see m68kcpu.h) */
 	m68ki_check_address_error(REG_PC, MODE_READ, FLAG_S | FUNCTION_CODE_USER_PROGRAM); /* auto-disable (see m68kcpu.h) */
 
-#if M68K_SEPARATE_READS
-#if M68K_EMULATE_PMMU
-	if (PMMU_ENABLED)
-	    address = pmmu_translate_addr(address);
-#endif
-#endif
-
 #if M68K_EMULATE_PREFETCH
 {
 	uint result;
@@ -1066,9 +1215,25 @@ static inline uint m68ki_read_imm_16(void)
 	CPU_PREF_DATA = m68k_read_immediate_16(ADDRESS_68K(CPU_PREF_ADDR));
 	return result;
 }
+#elif M68K_FETCH_POINTER
+{
+	uint offset = ADDRESS_68K(REG_PC) - CPU_FETCH_START;
+	if(offset >= CPU_FETCH_LIMIT16)
+	{
+		m68ki_fetch_refresh(ADDRESS_68K(REG_PC));
+		offset = ADDRESS_68K(REG_PC) - CPU_FETCH_START;
+		if(offset >= CPU_FETCH_LIMIT16)
+		{
+			REG_PC += 2;
+			return m68k_read_immediate_16(ADDRESS_68K(m68ki_mmu_program(REG_PC-2)));
+		}
+	}
+	REG_PC += 2;
+	return (CPU_FETCH_HOST[offset] << 8) | CPU_FETCH_HOST[offset+1];
+}
 #else
 	REG_PC += 2;
-	return m68k_read_immediate_16(ADDRESS_68K(REG_PC-2));
+	return m68k_read_immediate_16(ADDRESS_68K(m68ki_mmu_program(REG_PC-2)));
 #endif /* M68K_EMULATE_PREFETCH */
 }
 
@@ -1080,13 +1245,6 @@ static inline uint m68ki_read_imm_8(void)
 
 static inline uint m68ki_read_imm_32(void)
 {
-#if M68K_SEPARATE_READS
-#if M68K_EMULATE_PMMU
-	if (PMMU_ENABLED)
-	    address = pmmu_translate_addr(address);
-#endif
-#endif
-
 #if M68K_EMULATE_PREFETCH
 	uint temp_val;
 
@@ -1112,6 +1270,24 @@ static inline uint m68ki_read_imm_32(void)
 #else
 	m68ki_set_fc(FLAG_S | FUNCTION_CODE_USER_PROGRAM); /* auto-disable (see m68kcpu.h) */
 	m68ki_check_address_error(REG_PC, MODE_READ, FLAG_S | FUNCTION_CODE_USER_PROGRAM); /* auto-disable (see m68kcpu.h) */
+#if M68K_FETCH_POINTER
+	{
+		uint offset = ADDRESS_68K(REG_PC) - CPU_FETCH_START;
+		if(offset < CPU_FETCH_LIMIT32)
+		{
+			const uint8* p = CPU_FETCH_HOST + offset;
+			REG_PC += 4;
+			return (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+		}
+	}
+#endif /* M68K_FETCH_POINTER */
+#if M68K_EMULATE_PMMU
+	if(PMMU_ENABLED)                     /* The halves may be on different pages */
+	{
+		uint high = m68ki_read_imm_16();
+		return (high << 16) | m68ki_read_imm_16();
+	}
+#endif
 	REG_PC += 4;
 	return m68k_read_immediate_32(ADDRESS_68K(REG_PC-4));
 #endif /* M68K_EMULATE_PREFETCH */
@@ -1132,7 +1308,7 @@ static inline uint m68ki_read_8_fc(uint address, uint fc)
 
 #if M68K_EMULATE_PMMU
 	if (PMMU_ENABLED)
-	    address = pmmu_translate_addr(address);
+	    address = m68ki_mmu_translate(address, fc, 0);
 #endif
 
 	return m68k_read_memory_8(ADDRESS_68K(address));
@@ -1145,7 +1321,7 @@ static inline uint m68ki_read_16_fc(uint address, uint fc)
 
 #if M68K_EMULATE_PMMU
 	if (PMMU_ENABLED)
-	    address = pmmu_translate_addr(address);
+	    address = m68ki_mmu_translate(address, fc, 0);
 #endif
 
 	return m68k_read_memory_16(ADDRESS_68K(address));
@@ -1158,7 +1334,7 @@ static inline uint m68ki_read_32_fc(uint address, uint fc)
 
 #if M68K_EMULATE_PMMU
 	if (PMMU_ENABLED)
-	    address = pmmu_translate_addr(address);
+	    address = m68ki_mmu_translate(address, fc, 0);
 #endif
 
 	return m68k_read_memory_32(ADDRESS_68K(address));
@@ -1171,9 +1347,10 @@ static inline void m68ki_write_8_fc(uint address, uint fc, uint value)
 
 #if M68K_EMULATE_PMMU
 	if (PMMU_ENABLED)
-	    address = pmmu_translate_addr(address);
+	    address = m68ki_mmu_translate(address, fc, 1);
 #endif
 
+	m68ki_count_write(address); /* auto-disable (see m68kcpu.h) */
 	m68k_write_memory_8(ADDRESS_68K(address), value);
 }
 static inline void m68ki_write_16_fc(uint address, uint fc, uint value)
@@ -1184,9 +1361,10 @@ static inline void m68ki_write_16_fc(uint address, uint fc, uint value)
 
 #if M68K_EMULATE_PMMU
 	if (PMMU_ENABLED)
-	    address = pmmu_translate_addr(address);
+	    address = m68ki_mmu_translate(address, fc, 1);
 #endif
 
+	m68ki_count_write(address); /* auto-disable (see m68kcpu.h) */
 	m68k_write_memory_16(ADDRESS_68K(address), value);
 }
 static inline void m68ki_write_32_fc(uint address, uint fc, uint value)
@@ -1197,9 +1375,10 @@ static inline void m68ki_write_32_fc(uint address, uint fc, uint value)
 
 #if M68K_EMULATE_PMMU
 	if (PMMU_ENABLED)
-	    address = pmmu_translate_addr(address);
+	    address = m68ki_mmu_translate(address, fc, 1);
 #endif
 
+	m68ki_count_write(address); /* auto-disable (see m68kcpu.h) */
 	m68k_write_memory_32(ADDRESS_68K(address), value);
 }
 
@@ -1212,9 +1391,10 @@ static inline void m68ki_write_32_pd_fc(uint address, uint fc, uint value)
 
 #if M68K_EMULATE_PMMU
 	if (PMMU_ENABLED)
-	    address = pmmu_translate_addr(address);
+	    address = m68ki_mmu_translate(address, fc, 1);
 #endif
 
+	m68ki_count_write(address); /* auto-disable (see m68kcpu.h) */
 	m68k_write_memory_32_pd(ADDRESS_68K(address), value);
 }
 #endif
@@ -1907,14 +2087,16 @@ static inline void m68ki_exception_privilege_violation(void)
 	USE_CYCLES(CYC_EXCEPTION[EXCEPTION_PRIVILEGE_VIOLATION] - CYC_INSTRUCTION[REG_IR]);
 }
 
-extern jmp_buf m68ki_bus_error_jmp_buf;
+extern M68K_THREAD_LOCAL jmp_buf m68ki_bus_error_jmp_buf;
 
 #define m68ki_check_bus_error_trap() setjmp(m68ki_bus_error_jmp_buf)
 
 /* Exception for bus error */
 static inline void m68ki_exception_bus_error(void)
 {
+#if M68K_EMULATE_BUS_ERROR
 	int i;
+#endif
 
 	/* If we were processing a bus error, address error, or reset,
 	 * while writing the stack frame, this is a catastrophic failure.
@@ -1931,9 +2113,11 @@ static inline void m68ki_exception_bus_error(void)
 	/* Use up some clock cycles and undo the instruction's cycles */
 	USE_CYCLES(CYC_EXCEPTION[EXCEPTION_BUS_ERROR] - CYC_INSTRUCTION[REG_IR]);
 
+#if M68K_EMULATE_BUS_ERROR
 	for (i = 15; i >= 0; i--){
 		REG_DA[i] = REG_DA_SAVE[i];
 	}
+#endif
 
 	uint sr = m68ki_init_exception();
 
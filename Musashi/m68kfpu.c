@@ -1,4 +1,5 @@
 #include <math.h>
+#include <float.h>
 #include <stdio.h>
 #include <stdarg.h>
 
@@ -60,6 +61,219 @@ static inline floatx80 double_to_fx80(double in)
 	return float64_to_floatx80(*d);
 }
 
+// FSQRT, FDIV, FADD, FMUL, FSUB and FCMP (opmode) on softfloat
+static floatx80 fpu_soft(int opmode, floatx80 dst, floatx80 src)
+{
+	switch (opmode)
+	{
+		case 0x04:	return floatx80_sqrt(src);
+		case 0x20:
+		case 0x60:	return floatx80_div(dst, src);
+		case 0x22:	return floatx80_add(dst, src);
+		case 0x23:
+		case 0x63:	return floatx80_mul(dst, src);
+		default:	return floatx80_sub(dst, src);
+	}
+}
+
+#if M68K_FPU_HOST
+static M68K_THREAD_LOCAL int fpu_mode = M68K_FPU_EXACT;
+static M68K_THREAD_LOCAL int fpu_reports = 0;
+
+// x87 long double has the same layout as floatx80, other hosts have to use double
+#if LDBL_MANT_DIG == 64 && (defined(__x86_64__) || defined(__i386__))
+typedef long double fpu_host_t;
+#define FPU_HOST_EXP_MAX	0x3fff
+#define FPU_HOST_SQRT(x)	sqrtl(x)
+
+static inline fpu_host_t fx80_to_host(floatx80 fx)
+{
+	union { long double f; struct { uint64 low; uint16 high; } x; } u;
+
+	u.x.low = fx.low;
+	u.x.high = fx.high;
+	return u.f;
+}
+
+static inline floatx80 host_to_fx80(fpu_host_t in)
+{
+	union { long double f; struct { uint64 low; uint16 high; } x; } u;
+	floatx80 fx;
+
+	u.f = in;
+	fx.low = u.x.low;
+	fx.high = u.x.high;
+	return fx;
+}
+#else
+typedef double fpu_host_t;
+#define FPU_HOST_EXP_MAX	1000
+#define FPU_HOST_SQRT(x)	sqrt(x)
+#define fx80_to_host		fx80_to_double
+#define host_to_fx80		double_to_fx80
+#endif
+
+// Zero, or a normal number in range of the host type
+static inline int fpu_host_ok(floatx80 fx)
+{
+	int exp = fx.high & 0x7fff;
+
+	if (exp == 0)
+		return fx.low == 0;
+	return exp - 0x3fff < FPU_HOST_EXP_MAX && 0x3fff - exp < FPU_HOST_EXP_MAX && (fx.low >> 63) != 0;
+}
+
+// The same on the host, returns 0 if it has to be left to softfloat
+static int fpu_host(int opmode, floatx80 dst, floatx80 src, floatx80 *res)
+{
+	fpu_host_t a = fx80_to_host(dst);
+	fpu_host_t b = fx80_to_host(src);
+	fpu_host_t r;
+
+	if (float_rounding_mode != float_round_nearest_even || !fpu_host_ok(src) || (opmode != 0x04 && !fpu_host_ok(dst)))
+		return 0;
+	switch (opmode)
+	{
+		case 0x04:	if (b < 0) return 0;
+					r = FPU_HOST_SQRT(b);
+					break;
+		case 0x20:
+		case 0x60:	if (b == 0) return 0;
+					r = a / b;
+					break;
+		case 0x22:	r = a + b;
+					break;
+		case 0x23:
+		case 0x63:	r = a * b;
+					break;
+		default:	r = a - b;
+					break;
+	}
+	*res = host_to_fx80(r);
+	return fpu_host_ok(*res);						// overflow and underflow are left to softfloat
+}
+
+static void fpu_report(int opmode, floatx80 dst, floatx80 src, floatx80 soft, floatx80 host, const char *where)
+{
+	if (fpu_reports++ < 100)
+	{
+		fprintf(stderr, "FPU: %02X %04X:%016llX %04X:%016llX softfloat %04X:%016llX host %04X:%016llX%s\n", opmode,
+			dst.high, (unsigned long long)dst.low, src.high, (unsigned long long)src.low,
+			soft.high, (unsigned long long)soft.low, host.high, (unsigned long long)host.low, where);
+	}
+	else if (fpu_reports == 101)
+	{
+		fprintf(stderr, "FPU: further differences not reported\n");
+	}
+}
+
+int m68k_set_fpu_mode(int mode)
+{
+	fpu_mode = mode;
+	return fpu_mode;
+}
+
+// Operand for m68k_fpu_check(), between 2^-32 and 2^31 or over most of the range if wide
+static floatx80 fpu_check_operand(uint64 *seed, int wide)
+{
+	floatx80 fx;
+	int n;
+
+	*seed = *seed * U64(6364136223846793005) + U64(1442695040888963407);
+	n = (int)(*seed >> 58) - 32;
+	fx.high = (uint16)(((*seed >> 40) & 0x8000) | (0x3fff + n * (wide ? 500 : 1)));
+	fx.low = (*seed ^ (*seed << 23)) | U64(0x8000000000000000);
+	return fx;
+}
+
+// Every operation over a fixed set of operands, both ways
+int m68k_fpu_check(void)
+{
+	static const uint16 high[] = { 0x0000, 0x8000, 0x3fff, 0xbfff, 0x4000, 0x3ffe, 0x3ffd, 0x4000, 0x4000, 0x4002,
+									0x4020, 0x0001, 0x7ffe, 0x3fff, 0x3fff, 0x0000, 0x7fff, 0x7fff, 0x3c00, 0x43fe };
+	static const uint64 low[] = { 0, 0, U64(0x8000000000000000), U64(0x8000000000000000), U64(0x8000000000000000),
+									U64(0x8000000000000000), U64(0xaaaaaaaaaaaaaaab), U64(0xc90fdaa22168c235),
+									U64(0xadf85458a2bb4a9b), U64(0xa000000000000000), U64(0x9502f90000000000),
+									U64(0x8000000000000000), U64(0xffffffffffffffff), U64(0x8000000000000001),
+									U64(0xffffffffffffffff), U64(0x0000000000000001), U64(0x8000000000000000),
+									U64(0xc000000000000000), U64(0xfffffffffffff800), U64(0x8000000000000800) };
+	static const int ops[] = { 0x04, 0x20, 0x22, 0x23, 0x28 };
+	const int fixed = sizeof(high) / sizeof(high[0]);
+	uint64 seed = 1;
+	int i, op, done = 0, differ = 0, was = fpu_reports;
+	floatx80 a, b, soft, host;
+
+	fpu_reports = 0;
+	for (i = 0; i < fixed * fixed + 20000; i++)
+	{
+		if (i < fixed * fixed)						// every pair of the fixed operands
+		{
+			a.high = high[i / fixed]; a.low = low[i / fixed];
+			b.high = high[i % fixed]; b.low = low[i % fixed];
+		}
+		else										// then made up ones, some close together
+		{
+			a = fpu_check_operand(&seed, (i & 3) == 0);
+			b = fpu_check_operand(&seed, (i & 3) == 0);
+			if ((i & 7) == 1)
+			{
+				b.high = a.high;
+				b.low = a.low ^ (seed & 0xff);
+			}
+		}
+		for (op = 0; op < (int)(sizeof(ops) / sizeof(ops[0])); op++)
+		{
+			if (!fpu_host(ops[op], a, b, &host))
+				continue;
+			done++;
+			soft = fpu_soft(ops[op], a, b);
+			if (soft.high != host.high || soft.low != host.low)
+			{
+				differ++;
+				fpu_report(ops[op], a, b, soft, host, "");
+			}
+		}
+	}
+	fprintf(stderr, "FPU: %d operations done on the host, %d differ from softfloat\n", done, differ);
+	fpu_reports = was;
+	return differ;
+}
+#else
+int m68k_set_fpu_mode(int mode)
+{
+	(void)mode;
+	return M68K_FPU_EXACT;
+}
+
+int m68k_fpu_check(void)
+{
+	return 0;
+}
+#endif /* M68K_FPU_HOST */
+
+// FSQRT, FDIV, FADD, FMUL, FSUB and FCMP (opmode) in the mode set by m68k_set_fpu_mode()
+static floatx80 fpu_arith(int opmode, floatx80 dst, floatx80 src)
+{
+#if M68K_FPU_HOST
+	floatx80 res, soft;
+	char where[16];
+
+	if (fpu_mode != M68K_FPU_EXACT && fpu_host(opmode, dst, src, &res))
+	{
+		if (fpu_mode == M68K_FPU_FAST)
+			return res;
+		soft = fpu_soft(opmode, dst, src);
+		if (soft.high != res.high || soft.low != res.low)
+		{
+			sprintf(where, " at %08X", REG_PPC);
+			fpu_report(opmode, dst, src, soft, res, where);
+		}
+		return soft;
+	}
+#endif
+	return fpu_soft(opmode, dst, src);
+}
+
 static inline floatx80 load_extended_float80(uint32 ea)
 {
 	uint32 d1,d2;
@@ -1207,7 +1421,7 @@ static void fpgen_rm_reg(uint16 w2)
 		}
 		case 0x04:		// FSQRT
 		{
-			REG_FP[dst] = floatx80_sqrt(source);
+			REG_FP[dst] = fpu_arith(opmode, REG_FP[dst], source);
 			SET_CONDITION_CODES(REG_FP[dst]);
 			USE_CYCLES(109);
 			break;
@@ -1241,14 +1455,14 @@ static void fpgen_rm_reg(uint16 w2)
   	    case 0x60:		// FSDIVS (JFF) (source has already been converted to floatx80)
 		case 0x20:		// FDIV
 		{
-			REG_FP[dst] = floatx80_div(REG_FP[dst], source);
+			REG_FP[dst] = fpu_arith(opmode, REG_FP[dst], source);
 		    SET_CONDITION_CODES(REG_FP[dst]); // JFF
 			USE_CYCLES(43);
 			break;
 		}
 		case 0x22:		// FADD
 		{
-			REG_FP[dst] = floatx80_add(REG_FP[dst], source);
+			REG_FP[dst] = fpu_arith(opmode, REG_FP[dst], source);
 			SET_CONDITION_CODES(REG_FP[dst]);
 			USE_CYCLES(9);
 			break;
@@ -1256,7 +1470,7 @@ static void fpgen_rm_reg(uint16 w2)
    		case 0x63:		// FSMULS (JFF) (source has already been converted to floatx80)
 		case 0x23:		// FMUL
 		{
-			REG_FP[dst] = floatx80_mul(REG_FP[dst], source);
+			REG_FP[dst] = fpu_arith(opmode, REG_FP[dst], source);
 			SET_CONDITION_CODES(REG_FP[dst]);
 			USE_CYCLES(11);
 			break;
@@ -1270,7 +1484,7 @@ static void fpgen_rm_reg(uint16 w2)
 		}
 		case 0x28:		// FSUB
 		{
-			REG_FP[dst] = floatx80_sub(REG_FP[dst], source);
+			REG_FP[dst] = fpu_arith(opmode, REG_FP[dst], source);
 			SET_CONDITION_CODES(REG_FP[dst]);
 			USE_CYCLES(9);
 			break;
@@ -1278,7 +1492,7 @@ static void fpgen_rm_reg(uint16 w2)
 		case 0x38:		// FCMP
 		{
 			floatx80 res;
-			res = floatx80_sub(REG_FP[dst], source);
+			res = fpu_arith(opmode, REG_FP[dst], source);
 			SET_CONDITION_CODES(res);
 			USE_CYCLES(7);
 			break;
@@ -0,0 +1,349 @@
+/* ======================================================================== */
+/* ========================= LICENSING & COPYRIGHT ======================== */
+/* ======================================================================== */
+/*
+ * Copyright Karl Stenerud.  All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * m68kjit.h - x86-64 translation of blocks from the block cache
+ *
+ * A block which has been replayed M68K_JIT_THRESHOLD times is translated
+ * into host code that does the same work as the replay loop in
+ * m68k_execute(), with the PC, cycle and register bookkeeping as inline
+ * stores.  Simple register instructions (moveq, move.l, add, sub, cmp, and,
+ * or, addq, subq, tst and clr between registers, nop) are translated
+ * directly, keeping the flags in Musashi's form.  Everything else,
+ * including all memory accesses, FPU instructions and exceptions, is a call
+ * to the normal opcode handler, so it goes through the usual memory
+ * interface.  The code leaves the block when the PC does not match the next
+ * instruction, the timeslice is used up, or the block has been invalidated
+ * by a handler writing to it.  Breakpoints are checked by page before the
+ * block is entered; if one may be set the block is replayed instead.
+ */
+
+#if M68KI_JIT
+
+#include <stddef.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#define M68K_JIT_THRESHOLD  16           /* Replays before a block is translated */
+#define M68K_JIT_ARENA      (16 << 20)   /* Bytes of host code */
+#define M68K_JIT_MAX_BLOCK  8192         /* Most host code one block can need */
+
+static M68K_THREAD_LOCAL uint8 *m68ki_jit_arena = NULL;  /* Host code, allocated when first enabled */
+static M68K_THREAD_LOCAL uint m68ki_jit_used;            /* Bytes of it used */
+static M68K_THREAD_LOCAL int m68ki_jit_enabled = 0;
+static M68K_THREAD_LOCAL uint8 *m68ki_jit_out;           /* Where the next byte goes */
+
+#define JIT_CPU(F)  ((uint)offsetof(m68ki_cpu_core, F))
+
+/* Non zero if a breakpoint may be set on either page holding the block */
+#if M68K_BREAKPOINT_HOOK
+#define m68ki_jit_breakpoint(B) (M68K_BREAKPOINT_PAGE((B)->low) || M68K_BREAKPOINT_PAGE((B)->high - 1))
+#else
+#define m68ki_jit_breakpoint(B) 0
+#endif
+
+static void m68ki_jit_bytes(const char *bytes, uint length)
+{
+	memcpy(m68ki_jit_out, bytes, length);
+	m68ki_jit_out += length;
+}
+
+static void m68ki_jit_dword(uint value)
+{
+	memcpy(m68ki_jit_out, &value, 4);
+	m68ki_jit_out += 4;
+}
+
+static void m68ki_jit_qword(const void *value)
+{
+	memcpy(m68ki_jit_out, &value, 8);
+	m68ki_jit_out += 8;
+}
+
+/* op dword [rbx+offset], imm32 (mov, cmp, add, sub) */
+static void m68ki_jit_cpu_imm(const char *op, uint offset, uint value)
+{
+	m68ki_jit_bytes(op, 2);
+	m68ki_jit_dword(offset);
+	m68ki_jit_dword(value);
+}
+
+/* op eax, dword [rbx+offset] (mov either way) */
+static void m68ki_jit_cpu_eax(const char *op, uint offset)
+{
+	m68ki_jit_bytes(op, 2);
+	m68ki_jit_dword(offset);
+}
+
+#define JIT_MOV_IMM  "\xc7\x83"          /* mov dword [rbx+d32], imm32 */
+#define JIT_CMP_IMM  "\x81\xbb"          /* cmp dword [rbx+d32], imm32 */
+#define JIT_ADD_IMM  "\x81\x83"          /* add dword [rbx+d32], imm32 */
+#define JIT_SUB_IMM  "\x81\xab"          /* sub dword [rbx+d32], imm32 */
+#define JIT_LOAD     "\x8b\x83"          /* mov eax, dword [rbx+d32] */
+#define JIT_STORE    "\x89\x83"          /* mov dword [rbx+d32], eax */
+
+/* jcc rel32 to the exit code, the offsets are filled in at the end */
+static void m68ki_jit_exit_if(const char *jcc, uint8 **fixups, uint *count)
+{
+	m68ki_jit_bytes(jcc, 2);
+	fixups[(*count)++] = m68ki_jit_out;
+	m68ki_jit_dword(0);
+}
+
+#define JIT_JNE  "\x0f\x85"
+#define JIT_JLE  "\x0f\x8e"
+
+/* Non zero if the opcode is translated rather than calling its handler */
+static int m68ki_jit_native(uint ir)
+{
+	return (ir & 0xf100) == 0x7000      /* moveq #d8,dx */
+		|| (ir & 0xf1f8) == 0x2000      /* move.l dy,dx */
+		|| (ir & 0xf0f8) == 0x5048      /* addq/subq.w #q,ay */
+		|| (ir & 0xf0f8) == 0x5088      /* addq/subq.l #q,ay */
+		|| (ir & 0xf0f8) == 0x5080      /* addq/subq.l #q,dy */
+		|| (ir & 0xb1f8) == 0x9080      /* add/sub.l dy,dx */
+		|| (ir & 0xb1f8) == 0x8080      /* and/or.l dy,dx */
+		|| (ir & 0xf1f8) == 0xb080      /* cmp.l dy,dx */
+		|| (ir & 0xfff8) == 0x4a80      /* tst.l dy */
+		|| (ir & 0xfff8) == 0x4280      /* clr.l dy */
+		|| ir == 0x4e71;                /* nop */
+}
+
+/* Set N and Z from eax, which is lost */
+static void m68ki_jit_nz(void)
+{
+	m68ki_jit_cpu_eax(JIT_STORE, JIT_CPU(not_z_flag));
+	m68ki_jit_bytes("\xc1\xe8\x18", 3);   /* shr eax, 24 */
+	m68ki_jit_cpu_eax(JIT_STORE, JIT_CPU(n_flag));
+}
+
+/* A long result is in eax.  Store it if dst isn't 0, and set the flags as
+ * the handler would: C, V (and X if extend) from the host flags of the
+ * operation if arith, otherwise clear.  Only the flag bits Musashi tests
+ * are set in C and V.
+ */
+static void m68ki_jit_flags_32(uint dst, int arith, int extend)
+{
+	if(arith)
+	{
+		m68ki_jit_bytes("\x0f\x92\xc2", 3);   /* setc dl */
+		m68ki_jit_bytes("\x0f\x90\xc1", 3);   /* seto cl */
+	}
+	if(dst)
+		m68ki_jit_cpu_eax(JIT_STORE, dst);
+	m68ki_jit_nz();
+	if(arith)
+	{
+		m68ki_jit_bytes("\x0f\xb6\xd2\xc1\xe2\x08", 6);   /* movzx edx, dl; shl edx, 8 */
+		m68ki_jit_cpu_eax("\x89\x93", JIT_CPU(c_flag));     /* mov [rbx+d32], edx */
+		if(extend)
+			m68ki_jit_cpu_eax("\x89\x93", JIT_CPU(x_flag));
+		m68ki_jit_bytes("\x0f\xb6\xc9\xc1\xe1\x07", 6);   /* movzx ecx, cl; shl ecx, 7 */
+		m68ki_jit_cpu_eax("\x89\x8b", JIT_CPU(v_flag));     /* mov [rbx+d32], ecx */
+	}
+	else
+	{
+		m68ki_jit_cpu_imm(JIT_MOV_IMM, JIT_CPU(v_flag), VFLAG_CLEAR);
+		m68ki_jit_cpu_imm(JIT_MOV_IMM, JIT_CPU(c_flag), CFLAG_CLEAR);
+	}
+}
+
+static void m68ki_jit_emit_native(uint ir)
+{
+	uint x = (ir >> 9) & 7;
+	uint y = ir & 7;
+
+	if((ir & 0xf100) == 0x7000)
+	{
+		uint res = MAKE_INT_8(MASK_OUT_ABOVE_8(ir));
+		m68ki_jit_cpu_imm(JIT_MOV_IMM, JIT_CPU(dar) + x * 4, res);
+		m68ki_jit_cpu_imm(JIT_MOV_IMM, JIT_CPU(n_flag), NFLAG_32(res));
+		m68ki_jit_cpu_imm(JIT_MOV_IMM, JIT_CPU(not_z_flag), res);
+		m68ki_jit_cpu_imm(JIT_MOV_IMM, JIT_CPU(v_flag), VFLAG_CLEAR);
+		m68ki_jit_cpu_imm(JIT_MOV_IMM, JIT_CPU(c_flag), CFLAG_CLEAR);
+	}
+	else if((ir & 0xf1f8) == 0x2000)
+	{
+		m68ki_jit_cpu_eax(JIT_LOAD, JIT_CPU(dar) + y * 4);
+		m68ki_jit_flags_32(JIT_CPU(dar) + x * 4, 0, 0);
+	}
+	else if((ir & 0xf0f8) == 0x5080)
+	{
+		uint quick = ((x - 1) & 7) + 1;
+		m68ki_jit_cpu_eax(JIT_LOAD, JIT_CPU(dar) + y * 4);
+		m68ki_jit_bytes((ir & 0x0100) ? "\x2d" : "\x05", 1);   /* sub/add eax, imm32 */
+		m68ki_jit_dword(quick);
+		m68ki_jit_flags_32(JIT_CPU(dar) + y * 4, 1, 1);
+	}
+	else if((ir & 0xf000) == 0x5000)
+	{
+		uint quick = ((x - 1) & 7) + 1;
+		m68ki_jit_cpu_imm((ir & 0x0100) ? JIT_SUB_IMM : JIT_ADD_IMM, JIT_CPU(dar) + (8 + y) * 4, quick);
+	}
+	else if((ir & 0xfff8) == 0x4a80 || (ir & 0xfff8) == 0x4280)
+	{
+		if(ir & 0x0800)
+			m68ki_jit_cpu_eax(JIT_LOAD, JIT_CPU(dar) + y * 4);
+		else
+			m68ki_jit_bytes("\x31\xc0", 2);   /* xor eax, eax */
+		m68ki_jit_flags_32((ir & 0x0800) ? 0 : JIT_CPU(dar) + y * 4, 0, 0);
+	}
+	else
+	{
+		uint line = ir >> 12;               /* or 8, sub 9, cmp b, and c, add d */
+		int arith = line == 0x9 || line == 0xb || line == 0xd;
+		m68ki_jit_cpu_eax(JIT_LOAD, JIT_CPU(dar) + x * 4);
+		m68ki_jit_cpu_eax(line == 0x8 ? "\x0b\x83" : line == 0xc ? "\x23\x83" :   /* op eax, [rbx+d32] */
+							line == 0xd ? "\x03\x83" : "\x2b\x83", JIT_CPU(dar) + y * 4);
+		m68ki_jit_flags_32(line == 0xb ? 0 : JIT_CPU(dar) + x * 4, arith, line != 0xb);
+	}
+}
+
+/* Translate a block, leaving block->code NULL if it can't be done */
+static void m68ki_jit_compile(m68ki_block *block)
+{
+	uint8 *fixups[M68K_BLOCK_LENGTH * 3];
+	uint count = 0;
+	uint8 *code;
+	uint i;
+	int native = 0;
+
+	if(((block->high - 1) >> 12) - (block->low >> 12) > 1)
+		return;                          /* Breakpoint pages can't be checked */
+	if(m68ki_jit_used + M68K_JIT_MAX_BLOCK > M68K_JIT_ARENA)
+	{
+		for(i = 0; i < M68K_BLOCK_COUNT; i++)  /* Full, start again */
+		{
+			m68ki_blocks[i].code = NULL;
+			m68ki_blocks[i].hits = 0;   /* So hot blocks get compiled again */
+		}
+		m68ki_jit_used = 0;
+	}
+	code = m68ki_jit_out = m68ki_jit_arena + m68ki_jit_used;
+
+	m68ki_jit_bytes("\x53\x41\x54\x41\x55", 5);   /* push rbx, r12, r13 */
+	m68ki_jit_bytes("\x48\xbb", 2);               /* mov rbx, &m68ki_cpu */
+	m68ki_jit_qword(&m68ki_cpu);
+	m68ki_jit_bytes("\x49\xbc", 2);               /* mov r12, &m68ki_remaining_cycles */
+	m68ki_jit_qword(&m68ki_remaining_cycles);
+	m68ki_jit_bytes("\x49\xbd", 2);               /* mov r13, &block->start */
+	m68ki_jit_qword(&block->start);
+
+	for(i = 0; i < block->length; i++)
+	{
+		m68ki_block_entry *e = &block->entry[i];
+
+		if(i > 0)
+		{
+			if(!native || e->pc != e[-1].pc + 2)  /* A handler may have changed the PC */
+			{
+				m68ki_jit_cpu_imm(JIT_CMP_IMM, JIT_CPU(pc), e->pc);
+				m68ki_jit_exit_if(JIT_JNE, fixups, &count);
+			}
+			m68ki_jit_bytes("\x41\x83\x3c\x24\x00", 5);   /* cmp dword [r12], 0 */
+			m68ki_jit_exit_if(JIT_JLE, fixups, &count);
+		}
+		m68ki_jit_cpu_imm(JIT_MOV_IMM, JIT_CPU(ppc), e->pc);
+#if M68K_EMULATE_BUS_ERROR
+		uint k;
+		for(k = 0; k < 4; k++)               /* REG_DA_SAVE, 16 bytes at a time */
+		{
+			m68ki_jit_bytes("\xf3\x0f\x6f\x83", 4);   /* movdqu xmm0, [rbx+d32] */
+			m68ki_jit_dword(JIT_CPU(dar) + k * 16);
+			m68ki_jit_bytes("\xf3\x0f\x7f\x83", 4);   /* movdqu [rbx+d32], xmm0 */
+			m68ki_jit_dword(JIT_CPU(dar_save) + k * 16);
+		}
+#endif
+		native = m68ki_jit_native(e->ir);
+		if(native)
+		{
+			m68ki_jit_emit_native(e->ir);
+			m68ki_jit_cpu_imm(JIT_MOV_IMM, JIT_CPU(pc), e->pc + 2);
+			m68ki_jit_bytes("\x41\x81\x2c\x24", 4);   /* sub dword [r12], imm32 */
+			m68ki_jit_dword(e->cycles);
+		}
+		else
+		{
+			m68ki_jit_cpu_imm(JIT_MOV_IMM, JIT_CPU(ir), e->ir);
+			m68ki_jit_cpu_imm(JIT_MOV_IMM, JIT_CPU(pc), e->pc + 2);
+			m68ki_jit_bytes("\x48\xb8", 2);           /* mov rax, handler */
+			m68ki_jit_bytes((const char *)&e->handler, 8);
+			m68ki_jit_bytes("\xff\xd0", 2);           /* call rax */
+			m68ki_jit_bytes("\x41\x81\x2c\x24", 4);   /* sub dword [r12], imm32 */
+			m68ki_jit_dword(e->cycles);
+			m68ki_jit_bytes("\x41\x81\x7d\x00", 4);   /* cmp dword [r13], imm32 */
+			m68ki_jit_dword(block->start);
+			m68ki_jit_exit_if(JIT_JNE, fixups, &count);
+		}
+	}
+
+	for(i = 0; i < count; i++)               /* All exits come here */
+	{
+		uint rel = (uint)(m68ki_jit_out - (fixups[i] + 4));
+		memcpy(fixups[i], &rel, 4);
+	}
+	m68ki_jit_bytes("\x41\x5d\x41\x5c\x5b\xc3", 6);  /* pop r13, r12, rbx; ret */
+
+	m68ki_jit_used += (uint)(m68ki_jit_out - code + 15) & ~15u;
+	memcpy(&block->code, &code, sizeof(block->code));   /* No cast from data to code in ISO C */
+}
+
+/* Turn translation on or off, returns non zero if it is on */
+int m68k_set_jit(int enable)
+{
+	uint i;
+
+	if(enable && m68ki_jit_arena == NULL)
+	{
+		void *arena = mmap(NULL, M68K_JIT_ARENA, PROT_READ | PROT_WRITE | PROT_EXEC,
+							MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if(arena == MAP_FAILED)
+			return 0;
+		m68ki_jit_arena = (uint8 *)arena;
+		m68ki_jit_used = 0;
+	}
+	for(i = 0; i < M68K_BLOCK_COUNT; i++)
+	{
+		m68ki_blocks[i].code = NULL;
+		m68ki_blocks[i].hits = 0;
+	}
+	if(!enable && m68ki_jit_arena != NULL)
+	{
+		munmap(m68ki_jit_arena, M68K_JIT_ARENA);   /* A thread finishing gives its arena back */
+		m68ki_jit_arena = NULL;
+	}
+	m68ki_jit_enabled = enable;
+	return m68ki_jit_enabled;
+}
+
+#else
+
+int m68k_set_jit(int enable)
+{
+	(void)enable;
+	return 0;
+}
+
+#endif /* M68KI_JIT */
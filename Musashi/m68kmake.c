@@ -260,6 +260,8 @@ FILE* g_input_file = NULL;
 FILE* g_prototype_file = NULL;
 FILE* g_table_file = NULL;
 
+int g_only_cpu = -1;      /* CPU the core is built for, -1 for all of them */
+
 int g_num_functions = 0;  /* Number of functions processed */
 int g_num_primitives = 0; /* Number of function primitives read */
 int g_line_number = 1;    /* Current line number */
@@ -833,6 +835,12 @@ void write_table_entry(FILE* filep, opcode_struct* op)
 	fprintf(filep, "\t{%-28s, 0x%04x, 0x%04x, {",
 		op->name, op->op_mask, op->op_match);
 
+	if(g_only_cpu >= 0)
+	{
+		fprintf(filep, "%3d}},\n", op->cycles[g_only_cpu]);
+		return;
+	}
+
 	for(i=0;i<NUM_CPUS;i++)
 	{
 		fprintf(filep, "%3d", op->cycles[i]);
@@ -867,6 +875,14 @@ void generate_opcode_handler(FILE* filep, body_struct* body, replace_struct* rep
 
 	/* Set the opcode structure and write the tables, prototypes, etc */
 	set_opcode_struct(opinfo, op, ea_mode);
+
+	/* Leave out opcodes the CPU doesn't have, they stay illegal */
+	if(g_only_cpu >= 0 && op->cpus[g_only_cpu] == UNSPECIFIED_CH)
+	{
+		free(op);
+		return;
+	}
+
 	get_base_name(str, op);
 	add_opcode_output_table_entry(op, str);
 	write_function_name(filep, str);
@@ -1227,6 +1243,9 @@ int main(int argc, char **argv)
 	char table_footer_insert[MAX_INSERT_LENGTH+1];
 	char ophandler_header_insert[MAX_INSERT_LENGTH+1];
 	char ophandler_footer_insert[MAX_INSERT_LENGTH+1];
+	/* Positional arguments */
+	int arg_count = 0;
+	int i;
 	/* Flags if we've processed certain parts already */
 	int prototype_header_read = 0;
 	int prototype_footer_read = 0;
@@ -1240,8 +1259,24 @@ int main(int argc, char **argv)
 	printf("\n\tMusashi v%s 68000, 68008, 68010, 68EC020, 68020, 68EC030, 68030, 68EC040, 68040 emulator\n", g_version);
 	printf("\t\tCopyright Karl Stenerud (kstenerud@gmail.com)\n\n");
 
+	/* Check for -cpu=xxx, which builds a core for just one CPU type */
+	for(i = 1; i < argc; i++)
+	{
+		if(strncmp(argv[i], "-cpu=", 5) == 0)
+		{
+			static const char* const cpu_names[NUM_CPUS] = {"000", "010", "020", "030", "040"};
+			for(g_only_cpu = NUM_CPUS-1; g_only_cpu >= 0; g_only_cpu--)
+				if(strcmp(argv[i] + 5, cpu_names[g_only_cpu]) == 0)
+					break;
+			if(g_only_cpu < 0)
+				error_exit("Unknown CPU type: %s (use 000, 010, 020, 030 or 040)", argv[i] + 5);
+		}
+		else
+			argv[++arg_count] = argv[i];
+	}
+
 	/* Check if output path and source for the input file are given */
-    if(argc > 1)
+    if(arg_count > 0)
 	{
 		char *ptr;
 		strcpy(output_path, argv[1]);
@@ -1250,7 +1285,7 @@ int main(int argc, char **argv)
 			*ptr = '/';
         if(output_path[strlen(output_path)-1] != '/')
 			strcat(output_path, "/");
-		if(argc > 2)
+		if(arg_count > 1)
 			strcpy(g_input_filename, argv[2]);
 	}
 
@@ -1285,6 +1320,8 @@ int main(int argc, char **argv)
 				error_exit("Duplicate prototype header");
 			read_insert(temp_insert);
 			fprintf(g_prototype_file, "%s\n\n", temp_insert);
+			if(g_only_cpu >= 0)
+				fprintf(g_prototype_file, "/* Built for one CPU type only (0 = 000 ... 4 = 040) */\n#define M68KOPS_ONLY_CPU %d\n\n\n", g_only_cpu);
 			prototype_header_read = 1;
 		}
 		else if(strcmp(section_id, ID_TABLE_HEADER) == 0)
@@ -1381,6 +1418,8 @@ int main(int argc, char **argv)
 			print_opcode_output_table(g_table_file);
 			fprintf(g_table_file, "%s\n\n", table_footer_insert);
 
+			if(g_only_cpu >= 0)
+				fprintf(g_prototype_file, "/* Handlers in the compact table, the first being illegal */\n#define M68KOPS_HANDLER_COUNT %d\n\n", g_opcode_output_table_length + 1);
 			fprintf(g_prototype_file, "%s\n\n", prototype_footer_insert);
 
 			break;
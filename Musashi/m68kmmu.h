@@ -171,6 +171,227 @@ uint pmmu_translate_addr(uint addr_in)
 	return addr_out;
 }
 
+/*
+	68040 paged MMU.  Two level table of 128 entry root and pointer tables
+	then a 32 or 64 entry page table, with 4K or 8K pages.  Results are kept
+	in the address translation caches (m68ki_cpu.mmu_atc) which
+	m68ki_mmu_translate() probes, these are only called when that misses.
+*/
+
+/* Empty both translation caches */
+static void m68ki_mmu_flush_all(void)
+{
+	memset(m68ki_cpu.mmu_atc, 0, sizeof(m68ki_cpu.mmu_atc));
+}
+
+/* PFLUSH, PFLUSHN, PFLUSHA and PFLUSHAN.  Global pages aren't kept apart
+ * so the N forms flush them as well, which is allowed as the ATC may lose
+ * entries at any time.
+ */
+void m68ki_mmu_pflush(uint address, int all)
+{
+	uint page = address & m68ki_cpu.mmu_page_mask;
+	uint i, j;
+
+	if(all)
+		m68ki_mmu_flush_all();
+	else
+		for(i = 0; i < 2; i++)
+			for(j = 0; j < M68K_MMU_ATC_SIZE; j++)
+				if((m68ki_cpu.mmu_atc[i][j].logical & m68ki_cpu.mmu_page_mask) == page)
+					m68ki_cpu.mmu_atc[i][j].logical = 0;
+	m68k_flush_fetch_pointer();
+}
+
+/* Check the transparent translation registers and then walk the tables.
+ * Sets *status to the MMUSR value for the address and returns non zero if
+ * the access is allowed, in which case the ATC entry is loaded and the used
+ * and modified bits are updated.
+ */
+static int m68ki_mmu_search(uint address, uint fc, int write, uint *status)
+{
+	uint super = fc & 4;
+	uint program = (fc & 3) == FUNCTION_CODE_USER_PROGRAM;
+	uint page_mask = m68ki_cpu.mmu_page_mask;
+	m68ki_mmu_atc *atc = &m68ki_cpu.mmu_atc[program][(address >> 12) & (M68K_MMU_ATC_SIZE - 1)];
+	uint i, tt, desc, desc_addr, wp = 0;
+
+	/* Transparent translation, ITT0/1 for program and DTT0/1 for data */
+	for(i = 0; i < 2; i++)
+	{
+		tt = m68ki_cpu.mmu_tt[(program ? 0 : 2) + i];
+		if((tt & 0x8000) && !(((address ^ tt) >> 24) & ~(tt >> 16) & 0xff)
+			&& ((tt & 0x4000) || ((tt >> 11) & 4) == super))
+		{
+			*status = (address & page_mask) | (tt & 4) | 3;
+			if(write && (tt & 4))
+				return 0;
+			atc->logical = (address & page_mask) | (super >> 1) | 1;
+			atc->physical = address & page_mask;
+			atc->write = !(tt & 4);
+			return 1;
+		}
+	}
+
+	*status = 0;
+	if(!(m68ki_cpu.mmu_tc & 0x8000))
+		return 0;
+
+	/* Root table, then pointer table, setting the used bits on the way */
+	desc_addr = ((super ? m68ki_cpu.mmu_srp_aptr : m68ki_cpu.mmu_urp_aptr) & 0xfffffe00) | ((address >> 23) & 0x1fc);
+	desc = m68k_read_memory_32(desc_addr);
+	if(!(desc & 2))
+		return 0;
+	if(!(desc & 8))
+		m68k_write_memory_32(desc_addr, desc | 8);
+	wp |= desc & 4;
+
+	desc_addr = (desc & 0xfffffe00) | ((address >> 16) & 0x1fc);
+	desc = m68k_read_memory_32(desc_addr);
+	if(!(desc & 2))
+		return 0;
+	if(!(desc & 8))
+		m68k_write_memory_32(desc_addr, desc | 8);
+	wp |= desc & 4;
+
+	/* Page table, the descriptor may be indirect */
+	if(m68ki_cpu.mmu_tc & 0x4000)
+		desc_addr = (desc & 0xffffff80) | ((address >> 11) & 0x7c);
+	else
+		desc_addr = (desc & 0xffffff00) | ((address >> 10) & 0xfc);
+	desc = m68k_read_memory_32(desc_addr);
+	if((desc & 3) == 2)
+	{
+		desc_addr = desc & 0xfffffffc;
+		desc = m68k_read_memory_32(desc_addr);
+	}
+	if(!(desc & 1))
+		return 0;
+	wp |= desc & 4;
+
+	*status = (desc & page_mask) | (desc & 0x7f0) | wp | 1;
+	if(((desc & 0x80) && !super) || (write && wp))
+		return 0;
+
+	if((desc & 8) == 0 || (write && !(desc & 0x10)))
+	{
+		desc |= write ? 0x18 : 8;
+		m68k_write_memory_32(desc_addr, desc);
+		*status |= desc & 0x10;
+	}
+
+	atc->logical = (address & page_mask) | (super >> 1) | 1;
+	atc->physical = desc & page_mask;
+	atc->write = !wp && (desc & 0x10);
+	return 1;
+}
+
+/* Format $7 access error stack frame, without any pending writebacks so
+ * RTE restarts the instruction.
+ */
+static void m68ki_stack_frame_0111(uint pc, uint sr, uint address, uint ssw)
+{
+	int i;
+
+	/* PUSH DATA LW 1-3, WRITEBACK 1-3 ADDRESS AND DATA */
+	for(i = 0; i < 9; i++)
+		m68ki_push_32(0);
+
+	/* FAULT ADDRESS */
+	m68ki_push_32(address);
+
+	/* WRITEBACK 1-3 STATUS */
+	m68ki_push_16(0);
+	m68ki_push_16(0);
+	m68ki_push_16(0);
+
+	/* SPECIAL STATUS WORD */
+	m68ki_push_16(ssw);
+
+	/* EFFECTIVE ADDRESS */
+	m68ki_push_32(address);
+
+	/* 0111, VECTOR OFFSET */
+	m68ki_push_16(0x7000 | (EXCEPTION_BUS_ERROR << 2));
+
+	/* PROGRAM COUNTER */
+	m68ki_push_32(pc);
+
+	/* STATUS REGISTER */
+	m68ki_push_16(sr);
+}
+
+/* Access error.  The registers go back to where they were at the start of
+ * the instruction, and the handler's RTE runs it again.
+ */
+static void m68ki_mmu_fault(uint address, uint fc, int write)
+{
+	uint sr;
+
+	/* Faulted writing the frame for a fault, halt the CPU */
+	if(CPU_RUN_MODE == RUN_MODE_BERR_AERR_RESET_WSF)
+	{
+		CPU_STOPPED = STOP_LEVEL_HALT;
+		return;
+	}
+	CPU_RUN_MODE = RUN_MODE_BERR_AERR_RESET_WSF;
+
+	memcpy(REG_DA, REG_DA_SAVE, sizeof(REG_DA));
+	sr = m68ki_init_exception();
+	m68ki_stack_frame_0111(REG_PPC, sr, address, 0x0400 | (write ? 0 : 0x0100) | (fc & 7));
+	m68ki_jump_vector(EXCEPTION_BUS_ERROR);
+
+	CPU_RUN_MODE = RUN_MODE_BERR_AERR_RESET;
+	USE_CYCLES(CYC_EXCEPTION[EXCEPTION_BUS_ERROR]);
+
+	longjmp(m68ki_bus_error_jmp_buf, 1);
+}
+
+/* ATC miss, walk the tables and fault if the access isn't allowed */
+uint m68ki_mmu_walk(uint address, uint fc, int write)
+{
+	uint status;
+
+	if(m68ki_mmu_search(address, fc, write, &status))
+		return (status & m68ki_cpu.mmu_page_mask) | (address & ~m68ki_cpu.mmu_page_mask);
+	m68ki_mmu_fault(address, fc, write);
+	return address;
+}
+
+/* PTESTR and PTESTW, search for the address and set MMUSR */
+void m68ki_mmu_ptest(uint address, uint fc, int write)
+{
+	m68ki_mmu_search(address, fc, write, &m68ki_cpu.mmu_mmusr);
+}
+
+/* MOVEC to TC, the transparent translation registers and root pointers */
+void m68ki_mmu_movec(uint reg, uint value)
+{
+	switch(reg)
+	{
+		case 0x003:	/* TC */
+			m68ki_cpu.mmu_tc = value & 0xc000;
+			m68ki_cpu.mmu_page_mask = (value & 0x4000) ? 0xffffe000 : 0xfffff000;
+			m68ki_cpu.pmmu_enabled = (value & 0x8000) != 0;
+			m68k_flush_code_cache();   /* Blocks are recorded by logical address */
+			break;
+		case 0x004:	/* ITT0 */
+		case 0x005:	/* ITT1 */
+		case 0x006:	/* DTT0 */
+		case 0x007:	/* DTT1 */
+			m68ki_cpu.mmu_tt[reg - 0x004] = value & 0xffffe364;
+			break;
+		case 0x806:	/* URP */
+			m68ki_cpu.mmu_urp_aptr = value & 0xfffffe00;
+			break;
+		case 0x807:	/* SRP */
+			m68ki_cpu.mmu_srp_aptr = value & 0xfffffe00;
+			break;
+	}
+	m68ki_mmu_flush_all();
+	m68k_flush_fetch_pointer();
+}
+
 /*
 
 	m68881_mmu_ops: COP 0 MMU opcode handling
@@ -273,6 +494,7 @@ void m68881_mmu_ops(void)
 										{
 											m68ki_cpu.pmmu_enabled = 0;
 										}
+										m68k_flush_fetch_pointer();
 										break;
 
 									case 2:	// supervisor root pointer
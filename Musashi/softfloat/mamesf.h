@@ -53,6 +53,12 @@ typedef sint64 sbits64;
 *----------------------------------------------------------------------------*/
 #define LIT64( a ) a##ULL
 
+/*----------------------------------------------------------------------------
+| Storage class of the rounding modes and exception flags.  They belong to the
+| FPU of the CPU running on this thread (M68K_PER_THREAD in m68kconf.h).
+*----------------------------------------------------------------------------*/
+#define SOFTFLOAT_THREAD_LOCAL M68K_THREAD_LOCAL
+
 /*----------------------------------------------------------------------------
 | The macro `INLINE' can be used before functions that should be inlined.  If
 | a compiler does not support explicit inlining, this macro should be defined
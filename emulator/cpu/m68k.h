@@ -44,6 +44,12 @@ extern "C" {
 #endif
 
 int CPUInterruptHandler(int n);
+int CPUBreakpointHook(unsigned int pc);
+int CPUMoveD0D0Hook(unsigned int pc);
+const unsigned char *MEMGetFetchPointer(unsigned int address,unsigned int *start,unsigned int *size);
+int MEMMarkCode(unsigned int address);
+int MEMIdleReads(void);
+unsigned char *MEMGetHostPointer(unsigned int address,unsigned int size,int write);
 
 /* ======================================================================== */
 /* ============================= CONFIGURATION ============================ */
@@ -56,6 +62,20 @@ int CPUInterruptHandler(int n);
 #include "m68kconf.h"
 #endif
 
+/* Storage class of the CPU state, see M68K_PER_THREAD */
+#if M68K_PER_THREAD
+#ifdef _MSC_VER
+#define M68K_THREAD_LOCAL __declspec(thread)
+#else
+#define M68K_THREAD_LOCAL __thread
+#endif
+#else
+#define M68K_THREAD_LOCAL
+#endif
+
+/* Breakpoint page bitmap of the CPU on this thread, one bit per 4k page */
+extern M68K_THREAD_LOCAL unsigned char *CPUBreakPages;
+
 /* ======================================================================== */
 /* ============================ GENERAL DEFINES =========================== */
 
@@ -296,6 +316,102 @@ void m68k_set_fc_callback(void  (*callback)(unsigned int new_fc));
 void m68k_set_instr_hook_callback(void  (*callback)(unsigned int pc));
 
 
+/* Set a callback to stop execution at a breakpoint.
+ * You must enable M68K_BREAKPOINT_HOOK in m68kconf.h.
+ * The CPU calls this callback just before the instruction hook.  If it
+ * returns non zero, m68k_execute() returns before executing the instruction.
+ * Default behavior: never break.
+ */
+void m68k_set_breakpoint_callback(int  (*callback)(unsigned int pc));
+
+
+/* Set a callback for the move.b d0,d0 instruction, a software breakpoint.
+ * You must enable M68K_MOVED0D0_HAS_CALLBACK in m68kconf.h.
+ * The CPU calls this callback when it reaches the instruction.  If it
+ * returns non zero, m68k_execute() returns with the PC still at the
+ * instruction, which has not been executed, as for a breakpoint.
+ * Default behavior: never break.
+ */
+void m68k_set_moved0d0_instr_callback(int  (*callback)(unsigned int pc));
+
+
+/* Set a callback to get host memory for instruction fetches.
+ * You must enable M68K_FETCH_POINTER in m68kconf.h.
+ * The CPU calls this when the PC leaves the block it last got.  Return the
+ * host address of *start, setting *start and *size, or NULL if the address
+ * must be read through m68k_read_memory_16().
+ * Default behavior: return NULL.
+ */
+void m68k_set_fetch_pointer_callback(const unsigned char *(*callback)(unsigned int address,unsigned int *start,unsigned int *size));
+
+/* Forget the host pointer used for instruction fetches.  Call this if the
+ * host memory returned by the fetch pointer callback is moved or unmapped.
+ */
+void m68k_flush_fetch_pointer(void);
+
+/* Set a callback to get host memory for MOVE16 and copy or fill loops.
+ * You must enable M68K_BLOCK_MOVE in m68kconf.h.
+ * Return the host address of address to address+size-1, or NULL if the CPU
+ * must go through the memory read and write functions.  write is non zero if
+ * the CPU is going to write there.
+ * Default behavior: return NULL.
+ */
+void m68k_set_host_pointer_callback(unsigned char *(*callback)(unsigned int address,unsigned int size,int write));
+
+/* Empty the block cache (M68K_BLOCK_CACHE in m68kconf.h).  Call this if
+ * memory holding code is remapped.
+ */
+void m68k_flush_code_cache(void);
+
+/* Throw away any cached blocks holding opcodes in address..address+size-1.
+ * The host must call this when it writes to an address passed to the
+ * block cache callback.
+ */
+void m68k_invalidate_code(unsigned int address, unsigned int size);
+
+/* Turn translation of the block cache into host code on or off
+ * (M68K_JIT in m68kconf.h).  Returns non zero if it is now on, which it
+ * can't be if the host isn't supported.  Turning it off frees the host
+ * code.  With M68K_PER_THREAD it is turned on and off for this thread only.
+ */
+int m68k_set_jit(int enable);
+
+/* Turn skipping the rest of the timeslice when the CPU is in a polling loop
+ * on or off (M68K_IDLE_LOOP in m68kconf.h).  On by default.
+ */
+void m68k_set_idle_skip(int enable);
+
+/* Number of timeslices M68K_IDLE_LOOP has skipped the rest of on this
+ * thread.  If it goes up the CPU has been waiting for an event, which is
+ * how a host can tell a program is sitting waiting for input.
+ */
+unsigned int m68k_idle_skips(void);
+
+/* Forget the loop M68K_IDLE_LOOP is watching, so it has to go round again
+ * before it is skipped.  Call this when anything it may be polling changes,
+ * and when a breakpoint is set, as the blocks of a loop being skipped aren't
+ * run to hit it.
+ */
+void m68k_forget_idle_loop(void);
+
+/* How the FPU does FADD, FSUB, FMUL, FDIV, FSQRT and FCMP (M68K_FPU_HOST in
+ * m68kconf.h).  M68K_FPU_EXACT uses softfloat, M68K_FPU_FAST the host's
+ * floating point where it can, and M68K_FPU_CHECK does both, keeps the
+ * softfloat result and reports to stderr where they differ.  Returns the mode
+ * now in use, which is always M68K_FPU_EXACT without M68K_FPU_HOST.
+ */
+#define M68K_FPU_EXACT 0
+#define M68K_FPU_FAST  1
+#define M68K_FPU_CHECK 2
+int m68k_set_fpu_mode(int mode);
+
+/* Run those operations over a fixed set of operands, and more made up from a
+ * fixed seed, on both softfloat and the host, reporting to stderr each one
+ * that differs.  Returns the number that differ.
+ */
+int m68k_fpu_check(void);
+
+
 
 /* ======================================================================== */
 /* ====================== FUNCTIONS TO ACCESS THE CPU ===================== */
@@ -308,7 +424,9 @@ void m68k_set_instr_hook_callback(void  (*callback)(unsigned int pc));
 void m68k_set_cpu_type(unsigned int cpu_type);
 
 /* Do whatever initialisations the core requires.  Should be called
- * at least once at init time.
+ * at least once at init time.  With M68K_PER_THREAD each thread running a
+ * CPU calls it to set up its own callbacks and block cache, and the opcode
+ * table they share is built once by whichever call comes first.
  */
 void m68k_init(void);
 
@@ -365,6 +483,16 @@ unsigned int m68k_get_context(void* dst);
 /* set the current cpu context */
 void m68k_set_context(void* dst);
 
+/* Get and set the registers and internal state of the current CPU, which is
+ * the context without its host pointers, so it can be written to a file and
+ * loaded by another run of the same build.  m68k_get_state() returns the
+ * size, which m68k_state_size() also does.  m68k_set_state() returns zero,
+ * changing nothing, if the state is for another CPU type.
+ */
+unsigned int m68k_state_size(void);
+unsigned int m68k_get_state(void* dst);
+int m68k_set_state(const void* src);
+
 /* Register the CPU state information */
 void m68k_state_register(const char *type, int index);
 
@@ -6,10 +6,27 @@
 /* ======================================================================== */
 
 
+/* Built for one CPU type only (0 = 000 ... 4 = 040) */
+#define M68KOPS_ONLY_CPU 4
+
+
+/* Handlers in the compact table, the first being illegal */
+#define M68KOPS_HANDLER_COUNT 1967
+
 /* Build the opcode handler table */
 void m68ki_build_opcode_table(void);
 
+#ifdef M68KOPS_ONLY_CPU
+/* One CPU type: opcodes index a short handler list, with one cycle table */
+extern unsigned short m68ki_instruction_index[0x10000];
+extern void (*m68ki_instruction_handlers[M68KOPS_HANDLER_COUNT])(void);
+#define m68ki_instruction_handler(A) m68ki_instruction_handlers[m68ki_instruction_index[A]]
+#define m68ki_cycle_column(A) 0
+#else
 extern void (*m68ki_instruction_jump_table[0x10000])(void); /* opcode handler jump table */
+#define m68ki_instruction_handler(A) m68ki_instruction_jump_table[A]
+#define m68ki_cycle_column(A) (A)
+#endif
 extern unsigned char m68ki_cycles[][0x10000];
 
 
@@ -18,6 +18,8 @@ static int inRunMode = 0;															// Non zero when free Running
 static int lastKey,currentKey;														// Last and Current key state
 static int stepBreakPoint;															// Extra breakpoint used for step over.
 static Uint32 nextFrame = 0;														// Time of next frame.
+static int turboFrames = 0; 														// Frames run for each one shown, 0 if not turbo
+static int turboSetting = DBG_TURBO_FRAMES;											// What turbo toggles it to.
 
 // *******************************************************************************************************************************
 //								Handle one frame of rendering etc. for the debugger.
@@ -43,6 +45,9 @@ void GFXXRender(SDL_Surface *surface,int autoStart,int scale) {
 		DBGDefineKey(DBGKEY_BREAK,GFXKEY_F6);	
 		DBGDefineKey(DBGKEY_HOME,GFXKEY_F2);		
 		DBGDefineKey(DBGKEY_SETBREAK,GFXKEY_F9);		
+		DBGDefineKey(DBGKEY_TURBO,GFXKEY_F4);
+		DBGDefineKey(DBGKEY_STEPBACK,GFXKEY_F10);
+		DBGDefineKey(DBGKEY_RUNBACK,GFXKEY_F11);
 		lastKey = currentKey = -1;
 	}
 
@@ -73,6 +78,10 @@ void GFXXRender(SDL_Surface *surface,int autoStart,int scale) {
 				GFXSetFrequency(0);
 			}
 
+			if (CMDKEY(DBGKEY_TURBO)) {												// Toggle turbo (F4)
+				turboFrames = (turboFrames != 0) ? 0 : turboSetting;
+			}
+
 			if (inRunMode == 0) {
 				GFXSetFrequency(0);													// Will drive us mental otherwise.
 				if (isxdigit(currentKey)) {											// Is it a hex digit 0-9 A-F.
@@ -92,12 +101,14 @@ void GFXXRender(SDL_Surface *surface,int autoStart,int scale) {
 					stepBreakPoint = -2;
 				}
 				if (CMDKEY(DBGKEY_STEP)) {											// Execute a single instruction (F7)
+					DEBUG_RECORD();
 					DEBUG_SINGLESTEP();
 					addressSettings[0] = DEBUG_HOMEPC();
 				}
 				if (CMDKEY(DBGKEY_STEPOVER)) {										// Step over program calls (F8)
 					stepBreakPoint = DEBUG_GETOVERBREAK();							// Where if anywhere should we break ?
 					if (stepBreakPoint == 0) {										// No step over, just single step.
+						DEBUG_RECORD();
 						DEBUG_SINGLESTEP();
 						addressSettings[0] = DEBUG_HOMEPC();
 					} else {
@@ -107,6 +118,14 @@ void GFXXRender(SDL_Surface *surface,int autoStart,int scale) {
 				if (CMDKEY(DBGKEY_SETBREAK)) {										// Set Breakpoint (F9)
 						addressSettings[3] = addressSettings[0];
 				}
+				if (CMDKEY(DBGKEY_STEPBACK)) {										// Step back an instruction (F10)
+					DEBUG_STEPBACK();
+					addressSettings[0] = DEBUG_HOMEPC();
+				}
+				if (CMDKEY(DBGKEY_RUNBACK)) {										// Run back to the breakpoint (F11)
+					DEBUG_RUNBACK(addressSettings[3]);
+					addressSettings[0] = DEBUG_HOMEPC();
+				}
 			} else {																// In Run mode.
 				if (CMDKEY(DBGKEY_BREAK)) {
 					inRunMode = 0;
@@ -116,17 +135,24 @@ void GFXXRender(SDL_Surface *surface,int autoStart,int scale) {
 		} 
 	}
 	if (inRunMode != 0) {															// Running a program.
-		int frameRate = DEBUG_RUN(addressSettings[3],stepBreakPoint);				// Run a frame, or try to.
-		if (frameRate == 0) {														// Run code with step breakpoint, maybe.
-			inRunMode = 0;															// Break has occurred.
-		} else {
+		int frames = (turboFrames != 0) ? turboFrames : 1; 							// In turbo only every Nth is shown.
+		int frameRate = 0;
+		while (frames-- > 0 && inRunMode != 0) {
+			DEBUG_RECORD();
+			frameRate = DEBUG_RUN(addressSettings[3],stepBreakPoint);				// Run a frame, or try to.
+			if (frameRate == 0) {													// Run code with step breakpoint, maybe.
+				inRunMode = 0;														// Break has occurred.
+			}
+		}
+		if (inRunMode != 0 && turboFrames == 0) { 									// Turbo doesn't wait for the host.
 			/*
 			int exceeded = SDL_GetTicks() - nextFrame;
 			if (exceeded > 0)
 				printf("Frame time exceeded by %d ms\n", exceeded);
 				*/
 
-			while (SDL_GetTicks() < nextFrame) { SDL_Delay(1); };									// Wait for frame timer to elapse.
+			Uint32 now = SDL_GetTicks();
+			if (now < nextFrame) SDL_Delay(nextFrame - now);						// Wait for frame timer to elapse.
 			nextFrame = SDL_GetTicks() + 1000 / frameRate;							// And calculate the next sync time.
 
 		}
@@ -154,6 +180,15 @@ void DBGVerticalLabel(int x,int y,const char *labels[],int fgr,int bgr) {
 	}
 }
 
+// *******************************************************************************************************************************
+//						Set the frames run for each one shown in turbo, and turn it on. Zero turns it off.
+// *******************************************************************************************************************************
+
+void DBGSetTurbo(int frames) {
+	if (frames != 0) turboSetting = frames;
+	turboFrames = frames;
+}
+
 // *******************************************************************************************************************************
 //												  Get if running or not.
 // *******************************************************************************************************************************
@@ -169,6 +204,8 @@ int DBGGetRunMode(void) {
 //	
 //		Date 			Changes
 //		---- 			-------
+//		17-10-2026 		Turbo mode (F4) runs several frames for each one shown and doesn't wait for the frame time.
+//		17-10-2026 		Step back (F10) and run back to the breakpoint (F11).
 //
 // *******************************************************************************************************************************
 // *******************************************************************************************************************************
@@ -16,6 +16,7 @@ void DBGVerticalLabel(int x,int y,const char *labels[],int fgr,int bgr);
 void DBGDefineKey(int keyID,int gfxKey);
 int DBGGetDisplayToggle(void);
 int DBGGetRunMode(void);
+void DBGSetTurbo(int frames);
 
 #include "sys_debug_system.h"
 
@@ -27,6 +28,11 @@ int DBGGetRunMode(void);
 #define DBGKEY_BREAK	(5)
 #define DBGKEY_HOME		(6)
 #define DBGKEY_SETBREAK	(7)
+#define DBGKEY_TURBO	(8)
+#define DBGKEY_STEPBACK	(9)
+#define DBGKEY_RUNBACK	(10)
+
+#define DBG_TURBO_FRAMES (10)														// Default frames run for each one shown in turbo.
 
 #endif
 
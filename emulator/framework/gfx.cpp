@@ -23,7 +23,7 @@ static int displaySelectCount = 0;
 static void _GFXInitialiseKeyRecord(void);
 static void _GFXUpdateKeyRecord(int scancode,int isDown);
 
-static Beeper beeper;
+static Beeper *beeper = NULL; 														// Created once audio is initialised.
 
 // *******************************************************************************************************************************
 //
@@ -46,6 +46,7 @@ void GFXOpenWindow(const char *title,int width,int height,int colour) {
 
 	background = colour;															// Remember required backgrounds.
 	_GFXInitialiseKeyRecord();														// Set up key system.
+	beeper = new Beeper();															// Open the audio.
 }
 
 // *******************************************************************************************************************************
@@ -108,6 +109,7 @@ void GFXCloseOnDebug(void) {
 // *******************************************************************************************************************************
 
 void GFXCloseWindow(void) {
+	delete beeper;beeper = NULL; 													// Close the audio.
 	SDL_DestroyWindow(mainWindow);													// Destroy working window
 	SDL_Quit();																		// Exit SDL.
 }
@@ -407,7 +409,7 @@ void audio_callback(void *_beeper, Uint8 *_stream, int _length)
 }
 
 void GFXSetFrequency(int freq) {
-	beeper.setFrequency(freq);
+	if (beeper != NULL) beeper->setFrequency(freq);
 }
 
 // *******************************************************************************************************************************
@@ -425,6 +427,7 @@ int GFXGetDisplayToggle(void) {
 //	
 //		Date 			Changes
 //		---- 			-------
+//		17-10-2026 		Beeper is created when the window is opened, so nothing opens audio without one.
 //
 // *******************************************************************************************************************************
 // *******************************************************************************************************************************
@@ -21,15 +21,124 @@ int getScale(int argc, char* argv[]) {
 	return 1;
 }
 
+int hasOption(int argc, char* argv[], const char *option) {
+	for (int i = 1; i < argc; ++ i) {
+		if (strcmp(argv[i], option) == 0) return 1;
+	}
+	return 0;
+}
+
+const char *getValue(int argc, char* argv[], const char *option) {
+	for (int i = 1; i < argc; ++ i) {
+		if (strncmp(argv[i], option, strlen(option)) == 0) return argv[i] + strlen(option);
+	}
+	return NULL;
+}
+
+// *******************************************************************************************************************************
+//		Run with no window, sound or frame timing until the program jumps to $FFFFFFFF, whose D0 is the exit code,
+//		or the -frames= or -cycles= limit is reached, which exits with HEADLESS_TIMEOUT. A loaded snapshot carries on
+//		from where it was saved. A replay with no limit runs to where the recording ended, and exits with zero if the
+//		machine matches the recording there, HEADLESS_MISMATCH if not.
+// *******************************************************************************************************************************
+
+#define HEADLESS_TIMEOUT 	(124)													// As timeout(1) does.
+#define HEADLESS_MISMATCH 	(125) 													// Replay ended differing from the recording.
+
+int runHeadless(int argc, char* argv[]) {
+	const char *frames = getValue(argc, argv, "-frames=");
+	const char *cycles = getValue(argc, argv, "-cycles=");
+	if (machine->resetJumpAddress != 0 && getValue(argc, argv, "-load=") == NULL) {
+		CPUReset();																	// Start a loaded executable, as F1 does.
+	}
+	if (CPURunBatch(frames ? atoi(frames) : 0,cycles ? strtoull(cycles,NULL,0) : REPLAYEndTime()) == 0) {
+		if (REPLAYResult() != 0) return REPLAYResult() == REPLAY_MATCHED ? 0 : HEADLESS_MISMATCH;
+		fprintf(stderr,"Limit reached without exit, PC:$%08x\n",CPUGetStatus()->pc);
+		return HEADLESS_TIMEOUT;
+	}
+	return CPUGetStatus()->d[0] & 0xFF;
+}
+
+// *******************************************************************************************************************************
+//													Snapshot options
+// *******************************************************************************************************************************
+
+void fastBoot(int argc, char* argv[]) {
+	const char *stop = getValue(argc, argv, "-fastboot=");
+	if (stop == NULL && !hasOption(argc, argv, "-fastboot")) return;
+	if (stop != NULL && *stop == '$') stop++;
+	if (!SNAPFastBoot(stop != NULL ? strtoul(stop,NULL,16) : 0)) {
+		fprintf(stderr,"Boot didn't finish, starting from reset\n");
+	}
+}
+
+void loadSnapshot(int argc, char* argv[]) {
+	const char *load = getValue(argc, argv, "-load=");
+	if (load != NULL && !SNAPLoadFile(load)) exit(fprintf(stderr,"Snapshot %s can't be loaded\n",load));
+}
+
+void saveSnapshot(int argc, char* argv[]) {
+	const char *save = getValue(argc, argv, "-save=");
+	if (save != NULL && !SNAPSaveFile(save)) exit(fprintf(stderr,"Snapshot %s can't be saved\n",save));
+}
+
+// *******************************************************************************************************************************
+//								Input recording options, started once the machine is set up
+// *******************************************************************************************************************************
+
+void startReplay(int argc, char* argv[]) {
+	const char *record = getValue(argc, argv, "-record=");
+	const char *replay = getValue(argc, argv, "-replay=");
+	if (record == NULL && replay == NULL) return;
+	if (machine->rewind != NULL || (record != NULL && replay != NULL)) {
+		exit(fprintf(stderr,"Only one of -record=, -replay= and -rewind can be used\n"));
+	}
+	if (record != NULL && !REPLAYRecord(record)) exit(fprintf(stderr,"Can't record to %s\n",record));
+	if (replay != NULL && !REPLAYPlay(replay)) {
+		exit(fprintf(stderr,"Recording %s can't be replayed, it needs the same ROM, files and options\n",replay));
+	}
+}
+
 int main(int argc,char *argv[]) {
 	char title[64];
 	sprintf(title,"%s (Build %d : %s)",WIN_TITLE,BUILD_COUNT,BUILD_TIME);
 	DEBUG_RESET();
+	fastBoot(argc, argv);															// Booted, before files are loaded.
 	int runNow = DEBUG_ARGUMENTS(argc,argv);
 
+	loadSnapshot(argc, argv);														// Replaces the machine, but not options.
 	int scale = getScale(argc, argv);
+	if (hasOption(argc, argv, "-jit") && !m68k_set_jit(1)) {
+		fprintf(stderr,"JIT is not available on this host, interpreting.\n");
+	}
+	if (hasOption(argc, argv, "-noidle")) m68k_set_idle_skip(0);
+	if (hasOption(argc, argv, "-fpu=fast")) m68k_set_fpu_mode(M68K_FPU_FAST);
+	if (hasOption(argc, argv, "-fpu=check")) { 										// Both ways, reporting differences.
+		m68k_set_fpu_mode(M68K_FPU_CHECK);
+		m68k_fpu_check();
+	}
+	const char *mhz = getValue(argc, argv, "-clock=");
+	if (mhz != NULL) {																// Emulated clock in MHz.
+		if (atoi(mhz) < 1 || atoi(mhz) > 1000) exit(fprintf(stderr,"Clock must be 1 to 1000 MHz\n"));
+		CPUSetClock(atoi(mhz));
+	}
+	if (hasOption(argc, argv, "-turbo")) DBGSetTurbo(DBG_TURBO_FRAMES);
+	const char *turbo = getValue(argc, argv, "-turbo=");
+	if (turbo != NULL) DBGSetTurbo(std::max(atoi(turbo), 1));						// Frames run for each one shown.
+	if (hasOption(argc, argv, "-rewind")) REWINDStart(REWIND_MEMORY);
+	const char *rewind = getValue(argc, argv, "-rewind=");
+	if (rewind != NULL) REWINDStart(std::max(atoi(rewind), 1));						// Mb of history kept.
+	startReplay(argc, argv);
+	if (hasOption(argc, argv, "-headless")) {
+		int exitCode = runHeadless(argc, argv);
+		REPLAYStop();
+		saveSnapshot(argc, argv);
+		return exitCode;
+	}
 	GFXOpenWindow(title,WIN_WIDTH * scale,WIN_HEIGHT * scale,WIN_BACKCOLOUR);
 	GFXStart(runNow,scale);
+	REPLAYStop();
+	saveSnapshot(argc, argv);
 	MEMEndRun();
 	GFXCloseWindow();
 	return(0);
@@ -42,6 +151,16 @@ int main(int argc,char *argv[]) {
 //	
 //		Date 			Changes
 //		---- 			-------
+//		17-10-2026 		Added -jit option.
+//		17-10-2026 		Added -noidle option.
+//		17-10-2026 		Added -fpu=fast and -fpu=check options.
+//		17-10-2026 		Added -headless, -frames= and -cycles= options.
+//		17-10-2026 		Added -clock= and -turbo options.
+//		17-10-2026 		Added -load= and -save= snapshot options.
+//		17-10-2026 		Added -fastboot option.
+//		17-10-2026 		Added -rewind option.
+//		17-10-2026 		Added -record= and -replay= options.
+//		18-10-2026 		A -headless replay exits with zero if it matches the recording.
 //
 // *******************************************************************************************************************************
 // *******************************************************************************************************************************
@@ -42,5 +42,8 @@
 #define HW_IS_GAVIN_READMAU(a)  ((a) == 0x40)
 #define HW_IS_GAVIN_RTC(a)  (((a) >= 0x80) && ((a) < 0x8a))
 #define HW_IS_GAVIN_INTERRUPTCTRL(a)  (((a) >= 0x100) && ((a) < 0x120))
-#define HW_IS_GAVIN_TIMERS(a)  (((a) >= 0x208) && ((a) < 0x230))
+#define HW_IS_GAVIN_TIMERS(a)  (((a) >= 0x200) && ((a) < 0x230))
+#define HW_IS_GAVIN_TIMERCTRL(a)  (((a) >= 0x200) && ((a) < 0x208))
 #define HW_IS_GAVIN_READPS2(a)  (((a) >= 0x2060) && ((a) < 0x2068))
+
+#define ISHWINTERCEPT(a) ((((a) >> 16) == 0xfec0))
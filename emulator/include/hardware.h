@@ -21,6 +21,7 @@
 
 void HWReset(void);
 void HWSync(void);
+void HWStartFrame(SCHEDTIME frameStart,int frameCycles);
 
 typedef struct _DisplayInfo
 {
@@ -37,7 +38,8 @@ int Gavin_Write(int offset,BYTE8 *memory,int value,int size);
 int GAVIN_InterruptLevel(void);
 void GAVIN_FlagInterrupt(int offset,int bitMask);
 void GAVIN_InsertMauFIFO(int mau);
-void GAVIN_UpdateTimers(int cycles,int frames);
+void GAVIN_Reset(void);
+void GAVIN_UpdateFrameTimers(void);
 int GAVIN_IdentifyInterrupt(int irq);
 void GAVINClearKeyboardQueue(void);
 
@@ -51,12 +53,26 @@ int HWConvertVickyTextLUT(BYTE8 *lut);
 int HWConvertVickyBitmapLUT(BYTE8 *lut);
 
 void  HWScanCodeHandler(int scancode,int keydown);
+void HWKeyEvent(int mau);
 
 int SRECHandler(int argc,char *argv[]);
 void FFMTLoad(char *fileName,int format);
+const BYTE8 *FFMTOpen(const char *fileName,size_t *size);
+void FFMTClose(const BYTE8 *data,size_t size);
+
+typedef struct _FFMTSymbol {
+	std::string name; 						// Name, empty for the end of a loaded segment
+	LONG32 size; 							// Size in bytes, zero if not known
+	int global; 							// Non zero for a global symbol
+} FFMTSYMBOL;
+
+typedef std::map<LONG32,FFMTSYMBOL> FFMTSYMBOLS; 	// Symbols by address
+
+const char *FFMTFindSymbol(LONG32 address,LONG32 *offset);
 
 #define FFMT_PGX 		(0)
 #define FFMT_PGZ 	 	(1)
+#define FFMT_ELF 	 	(2)
 
 #ifdef LINUX
 #define FILESEP '/'
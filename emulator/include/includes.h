@@ -15,14 +15,24 @@
 #include <ctype.h>
 #include <time.h>
 #include <queue>
+#include <unordered_set>
+#include <map>
+#include <string>
+#include <vector>
+#include <deque>
 #include <cmath>
 
 #include <SDL.h>
 
 #include <sys_processor.h>
+#include <scheduler.h>
 #include <hardware.h>
 #include <m68k.h>
 #include <setup.h>
+#include <rewind.h>
+#include <replay.h>
+#include <machine.h>
+#include <snapshot.h>
 #include <gfx.h>
 #include <debugger.h>
 #include <sys_debug_system.h>
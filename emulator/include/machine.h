@@ -0,0 +1,107 @@
+// *******************************************************************************************************************************
+// *******************************************************************************************************************************
+//
+//		Name:		machine.h
+//		Purpose:	Emulated machine instance (header)
+//		Created:	17th October 2026
+//		Author:		agent (agent@local)
+//
+//		Everything belonging to one A2560K is held in a MACHINE. Each thread has a current machine, which the memory
+//		callbacks from the CPU core and all the device code use, so separate threads can each run their own.
+//
+// *******************************************************************************************************************************
+// *******************************************************************************************************************************
+
+#ifndef _MACHINE_H
+#define _MACHINE_H
+
+#define MEM_PAGE_SHIFT 	(16) 															// 64k pages
+#define MEM_PAGES 		(1 << (32-MEM_PAGE_SHIFT))
+#define MEM_PAGE_MASK 	((1 << MEM_PAGE_SHIFT)-1)
+
+#define MEM_CODE_SHIFT 	(8) 															// Cached code tracked in 256 byte chunks
+
+#define VRAM_SIZE 		(VRAM_END-VRAM_START+1)										// Sizes of the memory regions.
+#define SDRAM_SIZE 		(64*1024*1024)
+
+typedef struct _GavinTimer {
+	LONG32 value; 																	// Counter value at 'base'
+	LONG32 compare; 																// Compare register
+	LONG32 load; 																	// Last value written to the counter
+	SCHEDTIME base; 																// Cycle the value was sampled at (timers 0-2)
+} GAVINTIMER;
+
+typedef struct _Machine {
+	//
+	//		Memory (memory.cpp)
+	//
+	BYTE8 *ramMemory;																// SRAM Memory at $000000
+	BYTE8 *flashMemory;																// Flash memory at end of memory
+	BYTE8 *videoMemory;																// Video RAM
+	BYTE8 *hwMemory; 																// RAM space & Registers in hardware area
+	#ifdef SDRAM_ENABLED
+	BYTE8 *sdMemory;																// 64 Mb SDRAM.
+	#endif
+	BYTE8 *readPage[MEM_PAGES]; 													// Host memory for each page, NULL if the
+	BYTE8 *writePage[MEM_PAGES]; 													// access has to go through the device code.
+	BYTE8 *writeHost[MEM_PAGES]; 													// Writeable host memory, even if write page is NULL.
+	BYTE8 codeChunk[1 << (32-MEM_CODE_SHIFT-3)]; 									// Bit set if chunk has cached opcodes.
+	int logBadAddress; 																// Log address errors.
+	int idleReads; 																	// Zero if a read may not repeat.
+	BYTE8 dirtyPage[MEM_PAGES/8];													// Bit set if page written since MEMClearDirty()
+	int dirtyTracking;																// Non zero if writes are being tracked.
+	//
+	//		Gavin (gavin.cpp)
+	//
+	BYTE8 icr[32];
+	BYTE8 mauQueue;
+	GAVINTIMER timers[5];
+	LONG32 tcr[2]; 																	// Timer control registers at $200,$204
+	//
+	//		Scheduler (scheduler.cpp)
+	//
+	SCHEDTIME eventTime[SCHED_EVENTS]; 												// When each event is due.
+	SCHEDHANDLER eventHandler[SCHED_EVENTS]; 										// Handler for each event.
+	int eventSlot[SCHED_EVENTS]; 													// Position in heap, -1 if not pending.
+	int heap[SCHED_EVENTS]; 														// Event numbers, earliest first.
+	int heapSize;
+	SCHEDTIME now; 																	// Cycle count at start of current slice.
+	SCHEDTIME sliceEnd; 															// Cycle count at end of current slice.
+	int running; 																	// Non zero while in m68k_execute()
+	//
+	//		Processor (sys_processor.cpp)
+	//
+	SCHEDTIME frameTime; 															// Cycle count at which the next frame starts.
+	int frameComplete; 																// Set by the start of frame event.
+	int resetJumpAddress; 															// Override reset address.
+	int clock; 																		// Clock speed in MHz, zero for the default.
+	BYTE8 breakPages[0x100000/8]; 													// One bit per 4k page containing a breakpoint
+	std::unordered_set<LONG32> *breakSet; 											// All execute breakpoints.
+	int breakEnabled; 																// Non zero when CPUExecute() checks breakpoints
+	int breakHit; 																	// Set when a breakpoint stops the CPU
+	//
+	//		CPU core registers, kept here while another machine is selected on this thread.
+	//
+	void *cpuContext;
+	int cpuSaved; 																	// Non zero if cpuContext is valid.
+	//
+	//		Debugger (rewind.cpp)
+	//
+	REWINDHISTORY *rewind;															// Rewind history, NULL if not kept.
+	//
+	//		Input recording (replay.cpp)
+	//
+	REPLAYLOG *replay;																// Recording or replay, NULL if neither.
+	//
+	//		Symbols from loaded ELF files (fileformats.cpp)
+	//
+	FFMTSYMBOLS *symbols;
+} MACHINE;
+
+extern M68K_THREAD_LOCAL MACHINE *machine; 											// Current machine on this thread.
+
+MACHINE *MACHINECreate(void);
+void MACHINEDestroy(MACHINE *m);
+void MACHINESelect(MACHINE *m);
+
+#endif
@@ -0,0 +1,46 @@
+// *******************************************************************************************************************************
+// *******************************************************************************************************************************
+//
+//		Name:		replay.h
+//		Purpose:	Input recording and replay (header)
+//		Created:	17th October 2026
+//		Author:		agent (agent@local)
+//
+// *******************************************************************************************************************************
+// *******************************************************************************************************************************
+
+#ifndef _REPLAY_H
+#define _REPLAY_H
+
+#define REPLAY_VERSION 		(1)														// Bump if the format changes.
+#define REPLAY_KEY 			(1)														// Key pressed or released, data is the MAU code.
+#define REPLAY_END 			(255)													// End of the recording, data is the machine's hash.
+
+typedef struct _ReplayEvent {
+	SCHEDTIME time;																	// Cycle count it happened at.
+	LONG32 type;
+	unsigned long long data;
+} REPLAYEVENT;
+
+typedef struct _ReplayLog {
+	FILE *file;																		// Recording to, NULL if replaying.
+	std::vector<REPLAYEVENT> events;												// Events to replay, in time order.
+	size_t next;																	// Next one due.
+	long long rtcStart;																// Local time in seconds at rtcCycle, for the RTC.
+	SCHEDTIME rtcCycle;
+	int result; 																	// REPLAY_MATCHED or REPLAY_DIFFERS once the end is reached.
+} REPLAYLOG;
+
+#define REPLAY_MATCHED 		(1) 													// Machine hash at the end is as recorded.
+#define REPLAY_DIFFERS 		(-1)													// It isn't.
+
+int REPLAYRecord(const char *fileName);
+int REPLAYPlay(const char *fileName);
+void REPLAYStop(void);
+int REPLAYIsPlaying(void);
+void REPLAYKey(int mau);
+struct tm *REPLAYLocalTime(void);
+SCHEDTIME REPLAYEndTime(void);
+int REPLAYResult(void);
+
+#endif
@@ -0,0 +1,36 @@
+// *******************************************************************************************************************************
+// *******************************************************************************************************************************
+//
+//		Name:		rewind.h
+//		Purpose:	Debugger rewind history (header)
+//		Created:	17th October 2026
+//		Author:		agent (agent@local)
+//
+// *******************************************************************************************************************************
+// *******************************************************************************************************************************
+
+#ifndef _REWIND_H
+#define _REWIND_H
+
+#define REWIND_KEYFRAME_GAP (60)													// Points between full snapshots.
+#define REWIND_MEMORY 		(64)													// Default Mb of history kept.
+
+typedef struct _RewindPoint {
+	SCHEDTIME time;																	// Cycle count it was taken at.
+	int keyframe;																	// Full snapshot, otherwise pages written since the one before.
+	std::vector<BYTE8> data;
+} REWINDPOINT;
+
+typedef struct _RewindHistory {
+	std::deque<REWINDPOINT> points;													// Oldest first, always starting with a keyframe.
+	size_t bytes,maxBytes;
+	SCHEDTIME frameTime;															// Frame the last point was taken in.
+} REWINDHISTORY;
+
+void REWINDStart(int megabytes);
+void REWINDStop(void);
+void REWINDRecord(void);
+int REWINDStepBack(void);
+int REWINDRunBack(LONG32 breakPoint);
+
+#endif
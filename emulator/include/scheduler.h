@@ -0,0 +1,34 @@
+// *******************************************************************************************************************************
+// *******************************************************************************************************************************
+//
+//		Name:		scheduler.h
+//		Purpose:	Hardware event scheduler (header)
+//		Created:	17th October 2026
+//		Author:		agent (agent@local)
+//
+// *******************************************************************************************************************************
+// *******************************************************************************************************************************
+
+#ifndef _SCHEDULER_H
+#define _SCHEDULER_H
+
+typedef unsigned long long SCHEDTIME; 												// Absolute CPU cycle count since reset.
+typedef void (*SCHEDHANDLER)(int event,SCHEDTIME when); 							// Called when an event falls due.
+
+#define SCHED_FRAME 		(0) 													// Start of frame, both Vickys.
+#define SCHED_LINE_A 		(1) 													// Vicky A line interrupts (3 compares)
+#define SCHED_LINE_B 		(4) 													// Vicky B line interrupts (3 compares)
+#define SCHED_TIMER 		(7) 													// Gavin timers 0-4, only 0-2 are clocked by the CPU.
+#define SCHED_INPUT 		(12)													// Inputs being replayed.
+
+#define SCHED_EVENTS 		(16) 													// Number of event slots.
+
+void SCHEDReset(void);
+void SCHEDSetHandler(int event,SCHEDHANDLER handler);
+void SCHEDPost(int event,SCHEDTIME when);
+void SCHEDCancel(int event);
+int SCHEDIsPending(int event);
+SCHEDTIME SCHEDGetTime(void);
+int SCHEDRun(int maxCycles);
+
+#endif
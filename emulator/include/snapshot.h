@@ -0,0 +1,32 @@
+// *******************************************************************************************************************************
+// *******************************************************************************************************************************
+//
+//		Name:		snapshot.h
+//		Purpose:	Machine snapshots (header)
+//		Created:	17th October 2026
+//		Author:		agent (agent@local)
+//
+// *******************************************************************************************************************************
+// *******************************************************************************************************************************
+
+#ifndef _SNAPSHOT_H
+#define _SNAPSHOT_H
+
+#define SNAP_VERSION 		(1) 													// Bump if the format or MACHINE changes.
+#define SNAP_FASTBOOT 		("fastboot-%016llx-%08x.snap")							// Fast boot file, ROM hash and stop PC.
+#define SNAP_BOOT_FRAMES 	(3600)													// Frames a boot may take.
+
+void SNAPCreate(std::vector<BYTE8> &snap);
+int SNAPRestore(const BYTE8 *snap,size_t size);
+int SNAPSaveFile(const char *fileName);
+int SNAPLoadFile(const char *fileName);
+void SNAPCreateDelta(std::vector<BYTE8> &snap);
+int SNAPApplyDelta(const BYTE8 *snap,size_t size);
+unsigned long long SNAPROMHash(void);
+unsigned long long SNAPHash(const BYTE8 *data,size_t size);
+
+#ifdef INCLUDE_DEBUGGING_SUPPORT
+int SNAPFastBoot(LONG32 stopPC);
+#endif
+
+#endif
@@ -36,6 +36,9 @@
 #define DEBUG_SINGLESTEP()	CPUExecuteInstruction()									// Execute a single instruction, return 0 or Frame rate on frame end.
 #define DEBUG_RUN(b1,b2) 	CPUExecute(b1,b2) 										// Run a frame or to breakpoint, returns -1 if breakpoint
 #define DEBUG_GETOVERBREAK() CPUGetStepOverBreakpoint()								// Where would we break to step over here. (0 == single step)
+#define DEBUG_RECORD() 		REWINDRecord() 											// Keep history for stepping back, if on.
+#define DEBUG_STEPBACK() 	REWINDStepBack() 										// Step back one instruction, 0 if no history.
+#define DEBUG_RUNBACK(b) 	REWINDRunBack(b) 										// Run back to breakpoint, 0 if not in history.
 
 #define DEBUG_RAMSTART 		(0x10000)												// Initial RAM address for debugger.
 #define DEBUG_SHIFT(d,v)	((((d) << 4) | v) & ADDRESS_MASK)						// Shifting into displayed address.
@@ -21,16 +21,31 @@ int CPUExecuteInstruction(void);
 BYTE8 CPUReadMemory(LONG32 address);
 void CPUWriteMemory(LONG32 address,BYTE8 data);
 void CPUOverrideReset(int addr);
+void CPUSetClock(int mhz);
+int CPUGetClock(void);
 
 void MEMLoadFlashROM(void);
+BYTE8 *MEMCreateRegion(LONG32 size,int huge);
+void MEMDestroyRegion(BYTE8 *region,LONG32 size);
+void MEMWriteBlock(LONG32 address,const BYTE8 *data,LONG32 size);
 void MEMSetAddressLog(int logBad);
+void MEMClearDirty(void);
+int MEMIsTracking(void);
+BYTE8 *MEMGetRAMPage(LONG32 page);
+BYTE8 *MEMGetDirtyPage(LONG32 page);
 
 #define PC 			(CPUGetStatus()->pc)
 
 #ifdef INCLUDE_DEBUGGING_SUPPORT													// Only required for debugging
 
 BYTE8 CPUExecute(LONG32 breakPoint1,LONG32 breakPoint2);
+int CPURunBatch(int frames,unsigned long long cycles);
+int CPUBoot(LONG32 stopPC,int maxFrames);
 LONG32 CPUGetStepOverBreakpoint(void);
+void CPUSetBreakpoint(LONG32 addr);
+void CPUClearBreakpoint(LONG32 addr);
+void CPUClearAllBreakpoints(void);
+int CPUIsBreakpoint(LONG32 addr);
 void CPUExit(void);
 
 void MEMEndRun(void);
@@ -118,6 +118,17 @@ class BasicConfiguration(object):
 				assert addr >= hwStart and addr <= hwEnd,chip+" not in hardware area"
 		for a in self.accessList:
 			h.write(a.getTestCode()+"\n")
+		#
+		#		64k pages with intercepted accesses, these can't be mapped directly.
+		#
+		pages = []
+		for a in self.accessList:
+			base = int(self.setup[a.getDevice()],16)
+			for p in range((base+a.startAddress) >> 16,((base+a.endAddress) >> 16)+1):
+				if p not in pages:
+					pages.append(p)
+		tests = " || ".join(["(((a) >> 16) == 0x{0:x})".format(p) for p in pages])
+		h.write("\n#define ISHWINTERCEPT(a) ({0})\n".format(tests if tests != "" else "0"))
 
 	#
 	def getMask(self,start,end):
@@ -145,7 +156,7 @@ class BasicConfiguration(object):
 						h.write("\tif ({0}(a)) {{\n".format(a.getTestName()))
 						s = 2 if size[0] == "W" else 4
 						s = 1 if size[0] == "B" else s
-						deviceMem = "(hwMemory + ADDR_GAVIN - HARDWARE_START)"
+						deviceMem = "(machine->hwMemory + ADDR_GAVIN - HARDWARE_START)"
 						if direction == "READ":
 							h.write("\t\treturn {0}_{1}(a,{2},{3});\n".format(self.caps(device),
 																	  		  self.caps(direction),
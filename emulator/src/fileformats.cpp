@@ -11,6 +11,13 @@
 
 #include <includes.h>
 
+#ifdef LINUX
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 // *******************************************************************************************************************************
 //
 // 												Format error
@@ -23,80 +30,219 @@ static void _FFMTError(const char *msg) {
 
 // *******************************************************************************************************************************
 //
-// 											 Read byte or word
+//		Whole file in memory, mapped where the host can, read in otherwise. NULL if it can't be opened. An empty
+//		file has a size of zero and no data to read.
 //
 // *******************************************************************************************************************************
 
-static int _FFMTReadBE(FILE *f,int size) {
-	int d = 0;
-	while (size -- > 0) {
-		int c = fgetc(f);
-		if (c < 0) return -1;
-		d = (d << 8) | (c & 0xFF);
+const BYTE8 *FFMTOpen(const char *fileName,size_t *size) {
+	#ifdef LINUX
+	int fd = open(fileName,O_RDONLY);
+	if (fd < 0) return NULL;
+	struct stat st;
+	void *data = MAP_FAILED;
+	*size = (fstat(fd,&st) == 0) ? (size_t) st.st_size : 0;
+	if (*size != 0) data = mmap(NULL,*size,PROT_READ,MAP_PRIVATE,fd,0);
+	close(fd);
+	if (*size == 0) return (const BYTE8 *) "";
+	return (data == MAP_FAILED) ? NULL : (const BYTE8 *) data;
+	#else
+	FILE *f = fopen(fileName,"rb");
+	if (f == NULL) return NULL;
+	fseek(f,0,SEEK_END);*size = ftell(f);fseek(f,0,SEEK_SET);
+	BYTE8 *data = (BYTE8 *) malloc(*size+1);
+	if (data != NULL && fread(data,1,*size,f) != *size) {
+		free(data);data = NULL;
 	}
+	fclose(f);
+	return data;
+	#endif
+}
+
+void FFMTClose(const BYTE8 *data,size_t size) {
+	#ifdef LINUX
+	if (size != 0) munmap((void *) data,size);
+	#else
+	free((void *) data);
+	#endif
+}
+
+// *******************************************************************************************************************************
+//
+// 											 Read byte or word
+//
+// *******************************************************************************************************************************
+
+static LONG32 _FFMTReadBE(const BYTE8 *p,int size) {
+	LONG32 d = 0;
+	while (size -- > 0) d = (d << 8) | *p++;
 	return d;
 }
 
-static int _FFMTReadLE(FILE *f,int size) {
-	int d = 0;
-	int shift = 0;
-	while (size -- > 0) {
-		int c = fgetc(f);
-		if (c < 0) return -1;
-		d |= (c << shift);
-		shift += 8;
-	}
+static LONG32 _FFMTReadLE(const BYTE8 *p,int size) {
+	LONG32 d = 0;
+	for (int i = size-1;i >= 0;i--) d = (d << 8) | p[i];
 	return d;
 }
 
 // *******************************************************************************************************************************
 //
-// 											Load PGX file
+// 								Load PGX file, a header then the data in one block
 //
 // *******************************************************************************************************************************
 
 static void _FFMTLoadPGX(char *fileName) {
-	char c1,c2,c3;
-	int c,address;
-	FILE *f = fopen(fileName,"rb");
-	if (f == NULL) _FFMTError("Cannot open file");
-//	printf("Loading %s\n",fileName);
-	c1 = fgetc(f);c2 = fgetc(f);c3 = fgetc(f);
-	if (c1 != 'P' || c2 != 'G' || c3 != 'X') _FFMTError("No PGX Header");
-	c1 = fgetc(f);if (c1 != 0x02) _FFMTError("Bad PGX File type");
-	address = _FFMTReadBE(f,4);
+	size_t size;
+	const BYTE8 *data = FFMTOpen(fileName,&size);
+	if (data == NULL) _FFMTError("Cannot open file");
+	if (size < 3 || data[0] != 'P' || data[1] != 'G' || data[2] != 'X') _FFMTError("No PGX Header");
+	if (size < 8 || data[3] != 0x02) _FFMTError("Bad PGX File type");
+	LONG32 address = _FFMTReadBE(data+4,4);
 	CPUOverrideReset(address);
-//	printf("Load to %x\n",address);
-	while (c = fgetc(f),c >= 0) {
-		m68k_write_memory_8(address++,c & 0xFF);
-	}
-	fclose(f);
+	MEMWriteBlock(address,data+8,size-8);
+	FFMTClose(data,size);
 }
 
 // *******************************************************************************************************************************
 //
-// 											Load PGZ file
+// 						Load PGZ file, segments of address, size and data, a size of zero is the start
 //
 // *******************************************************************************************************************************
 
 static void _FFMTLoadPGZ(char *fileName) {
-	char c1;
-	int address,size,wSize;
-	FILE *f = fopen(fileName,"rb");
-	if (f == NULL) _FFMTError("Cannot open file");
-//	printf("Loading %s\n",fileName);
-	c1 = fgetc(f);
-	if (c1 != 'Z' && c1 != 'z') _FFMTError("Bad PGZ initial character");
-	wSize = (c1 == 'Z') ? 3 : 4;
-	while (address = _FFMTReadLE(f,wSize),address >= 0) {
-		size = _FFMTReadLE(f,wSize);
-		if (size == 0) CPUOverrideReset(address);
-//		printf("Load to %x %d\n",address,size);
-		for (int i = 0;i < size;i++) {
-			m68k_write_memory_8(address++,fgetc(f) & 0xFF);
+	size_t size;
+	const BYTE8 *data = FFMTOpen(fileName,&size);
+	if (data == NULL) _FFMTError("Cannot open file");
+	if (size < 1 || (data[0] != 'Z' && data[0] != 'z')) _FFMTError("Bad PGZ initial character");
+	int wSize = (data[0] == 'Z') ? 3 : 4;
+	size_t pos = 1;
+	while (size - pos >= (size_t) wSize*2) { 										// Part of a header is ignored.
+		LONG32 address = _FFMTReadLE(data+pos,wSize);
+		LONG32 length = _FFMTReadLE(data+pos+wSize,wSize);
+		pos += wSize*2;
+		if (length == 0) CPUOverrideReset(address);
+		if (length > size - pos) _FFMTError("PGZ segment runs past the end of the file");
+		MEMWriteBlock(address,data+pos,length);
+		pos += length;
+	}
+	FFMTClose(data,size);
+}
+
+// *******************************************************************************************************************************
+//
+//		Load ELF file, a 32 bit big endian 68k executable. Each PT_LOAD segment is copied to its physical address, as
+//		the MCP does, with the rest of its memory size zeroed. The symbol table, if there is one, is added to the
+//		machine's symbols.
+//
+// *******************************************************************************************************************************
+
+#define ELF_HEADER_SIZE 	(52)
+#define ELF_PH_SIZE 		(32)													// Smallest entries we can read.
+#define ELF_SH_SIZE 		(40)
+#define ELF_SYM_SIZE 		(16)
+
+#define ELF_PT_LOAD 		(1)
+#define ELF_SHT_SYMTAB 		(2)
+#define ELF_SHN_LORESERVE 	(0xFF00)												// Section numbers from here are special.
+
+static int _FFMTInFile(size_t size,LONG32 offset,LONG32 count,LONG32 entrySize) {
+	return offset <= size && (unsigned long long) count * entrySize <= size - offset;
+}
+
+static void _FFMTZeroBlock(LONG32 address,LONG32 size) {
+	static const BYTE8 zero[4096] = { 0 };
+	while (size != 0) {
+		LONG32 n = (size < sizeof(zero)) ? size : sizeof(zero);
+		MEMWriteBlock(address,zero,n);
+		address += n;size -= n;
+	}
+}
+
+static void _FFMTAddSymbol(LONG32 address,const char *name,size_t length,LONG32 size,int global) {
+	FFMTSYMBOL &sym = (*machine->symbols)[address];
+	if (sym.name.empty() || (global && !sym.global)) {								// Globals win over locals.
+		sym.name.assign(name,length);
+		sym.size = size;sym.global = global;
+	}
+}
+
+static void _FFMTLoadELFSymbols(const BYTE8 *data,size_t size) {
+	LONG32 shOffset = _FFMTReadBE(data+32,4);
+	LONG32 shSize = _FFMTReadBE(data+46,2);
+	LONG32 shCount = _FFMTReadBE(data+48,2);
+	if (shOffset == 0 || shCount == 0) return;										// Stripped.
+	if (shSize < ELF_SH_SIZE || !_FFMTInFile(size,shOffset,shCount,shSize)) _FFMTError("Bad ELF section headers");
+	for (LONG32 i = 0;i < shCount;i++) {
+		const BYTE8 *sh = data + shOffset + i * shSize;
+		if (_FFMTReadBE(sh+4,4) != ELF_SHT_SYMTAB) continue;
+		LONG32 symOffset = _FFMTReadBE(sh+16,4);
+		LONG32 symSize = _FFMTReadBE(sh+36,4);
+		LONG32 link = _FFMTReadBE(sh+24,4);
+		if (symSize < ELF_SYM_SIZE || link >= shCount) _FFMTError("Bad ELF symbol table");
+		LONG32 symCount = _FFMTReadBE(sh+20,4) / symSize;
+		const BYTE8 *strSh = data + shOffset + link * shSize;						// Names are in the linked section.
+		LONG32 strOffset = _FFMTReadBE(strSh+16,4);
+		LONG32 strSize = _FFMTReadBE(strSh+20,4);
+		if (!_FFMTInFile(size,symOffset,symCount,symSize) || !_FFMTInFile(size,strOffset,strSize,1)) {
+			_FFMTError("ELF symbol table runs past the end of the file");
+		}
+		const char *strings = (const char *) data + strOffset;
+		for (LONG32 n = 1;n < symCount;n++) {										// Symbol 0 is always empty.
+			const BYTE8 *sym = data + symOffset + n * symSize;
+			LONG32 name = _FFMTReadBE(sym,4);
+			int type = sym[12] & 0x0F;												// Objects, functions and labels only.
+			LONG32 section = _FFMTReadBE(sym+14,2);
+			if (type > 2 || section == 0 || section >= ELF_SHN_LORESERVE || name >= strSize) continue;
+			size_t length = strnlen(strings+name,strSize-name);
+			if (length == 0) continue;
+			_FFMTAddSymbol(_FFMTReadBE(sym+4,4),strings+name,length,_FFMTReadBE(sym+8,4),(sym[12] >> 4) != 0);
 		}
 	}
-	fclose(f);
+}
+
+static void _FFMTLoadELF(char *fileName) {
+	size_t size;
+	const BYTE8 *data = FFMTOpen(fileName,&size);
+	if (data == NULL) _FFMTError("Cannot open file");
+	if (size < ELF_HEADER_SIZE || memcmp(data,"\x7F" "ELF",4) != 0) _FFMTError("No ELF Header");
+	if (data[4] != 1 || data[5] != 2 || _FFMTReadBE(data+18,2) != 4) _FFMTError("Not a 32 bit big endian 68k ELF file");
+	if (_FFMTReadBE(data+16,2) != 2) _FFMTError("ELF file is not an executable");
+	LONG32 phOffset = _FFMTReadBE(data+28,4);
+	LONG32 phSize = _FFMTReadBE(data+42,2);
+	LONG32 phCount = _FFMTReadBE(data+44,2);
+	if (phSize < ELF_PH_SIZE || !_FFMTInFile(size,phOffset,phCount,phSize)) _FFMTError("Bad ELF program headers");
+	CPUOverrideReset(_FFMTReadBE(data+24,4));
+	for (LONG32 i = 0;i < phCount;i++) {
+		const BYTE8 *ph = data + phOffset + i * phSize;
+		if (_FFMTReadBE(ph,4) != ELF_PT_LOAD) continue;
+		LONG32 offset = _FFMTReadBE(ph+4,4);
+		LONG32 address = _FFMTReadBE(ph+12,4);
+		LONG32 fileSize = _FFMTReadBE(ph+16,4);
+		LONG32 memSize = _FFMTReadBE(ph+20,4);
+		if (fileSize > memSize || !_FFMTInFile(size,offset,fileSize,1)) _FFMTError("ELF segment runs past the end of the file");
+		MEMWriteBlock(address,data+offset,fileSize);
+		_FFMTZeroBlock(address+fileSize,memSize-fileSize);							// .bss
+		if (memSize != 0) machine->symbols->emplace(address+memSize,FFMTSYMBOL());	// Symbols stop at the end.
+	}
+	_FFMTLoadELFSymbols(data,size);
+	FFMTClose(data,size);
+}
+
+// *******************************************************************************************************************************
+//
+//		Symbol containing an address, NULL if none. Symbols with no size reach to the next symbol or segment end.
+//
+// *******************************************************************************************************************************
+
+const char *FFMTFindSymbol(LONG32 address,LONG32 *offset) {
+	FFMTSYMBOLS *symbols = machine->symbols;
+	auto it = symbols->upper_bound(address);
+	if (it == symbols->begin()) return NULL;
+	--it;
+	*offset = address - it->first;
+	if (it->second.name.empty()) return NULL;
+	if (it->second.size != 0 && *offset >= it->second.size) return NULL;
+	return it->second.name.c_str();
 }
 
 // *******************************************************************************************************************************
@@ -108,6 +254,7 @@ static void _FFMTLoadPGZ(char *fileName) {
 void FFMTLoad(char *fileName,int format) {
 	if (format == FFMT_PGX) _FFMTLoadPGX(fileName);
 	if (format == FFMT_PGZ) _FFMTLoadPGZ(fileName);
+	if (format == FFMT_ELF) _FFMTLoadELF(fileName);
 }
 
 // *******************************************************************************************************************************
@@ -117,6 +264,8 @@ void FFMTLoad(char *fileName,int format) {
 //	
 //		Date 			Changes
 //		---- 			-------
+//		17-10-2026 		Files are mapped and loaded a block at a time.
+//		17-10-2026 		ELF executables and their symbols.
 //
 // *******************************************************************************************************************************
 // *******************************************************************************************************************************
@@ -11,9 +11,16 @@
 
 #include <includes.h>
 
-static BYTE8 icr[32];
-static BYTE8 mauQueue = 0;
-static LONG32 timers[5];
+#define TCR_ENABLE 	(0x01) 															// Timer control bits, per timer byte.
+#define TCR_CLEAR 	(0x02)
+#define TCR_LOAD 	(0x04)
+#define TCR_CNTUP 	(0x08)
+#define TCR_RECLR 	(0x10)
+#define TCR_RELOAD 	(0x20)
+#define TCR_INE 	(0x80)
+
+static LONG32 _GAVINReadTimer(int offset,int size);
+static void _GAVINWriteTimer(int offset,LONG32 value,int size);
 
 #define i_to_bcd(i) (((i) / 10) << 4) | ((i) % 10)
 
@@ -34,7 +41,7 @@ int Gavin_Read(int offset,BYTE8 *memory,int size) {
 	//		We manage the ICR ourselves
 	//
 	if (HW_IS_GAVIN_INTERRUPTCTRL(offset)) {
-		return icr[offset-0x100];
+		return machine->icr[offset-0x100];
 	}
 	//
 	// 		Reading the PS/2 port always returns zero, it's dead.
@@ -46,27 +53,28 @@ int Gavin_Read(int offset,BYTE8 *memory,int size) {
 	//		Read the head of the MAU FIFO Queue
 	//
 	if (HW_IS_GAVIN_READMAU(offset)) {
-		int qHead = mauQueue;
-		mauQueue = 0;
+		int qHead = machine->mauQueue;
+		machine->mauQueue = 0;
 		return qHead;
 	}
 	//
 	// 		Reading from timers
 	//
 	if (HW_IS_GAVIN_TIMERS(offset)) {
-		if ((offset & 7) == 0) {
-			return timers[(offset - 0x208) >> 3];
-		}
+		return _GAVINReadTimer(offset,size);
 	}
 	//
-	// 		Reading from RTC, update it with actual values before the read.
-	//		Writing will not work :)
+	// 		Reading from RTC, update it with actual values before the read, which are from the cycle count when
+	//		recording or replaying. Writing will not work :)
 	//
 	if (HW_IS_GAVIN_RTC(offset)) {
 	    struct tm* ptr;
 	    time_t t;
-	    t = time(NULL);
-	    ptr = localtime(&t);
+	    ptr = REPLAYLocalTime();
+	    if (ptr == NULL) {
+	    	t = time(NULL);
+	    	ptr = localtime(&t);
+	    }
 		memory[0x80] = i_to_bcd(ptr->tm_sec); 					// seconds
 		memory[0x82] = i_to_bcd(ptr->tm_min); 					// minuts
 		memory[0x84] = i_to_bcd(ptr->tm_hour); 					// hours
@@ -95,24 +103,22 @@ int Gavin_Write(int offset,BYTE8 *memory,int value,int size) {
 	//		Writing to ICR pending register ANDs the bits with the complemented value. 
 	//
 	if (HW_IS_GAVIN_IRQ_PENDING(offset)) {
-		icr[offset - 0x100] &= ~value;
+		machine->icr[offset - 0x100] &= ~value;
 		return 1;
 	}
 	//
 	//		Writing to ICR mask register replaces all bits. 
 	//
 	if (HW_IS_GAVIN_IRQ_MASK(offset)) {
-		icr[offset - 0x100] = value;
+		machine->icr[offset - 0x100] = value;
 		return 1;
 	}
 	//
 	// 		Writing to timers
 	//
 	if (HW_IS_GAVIN_TIMERS(offset)) {
-		if ((offset & 7) == 0) {
-			timers[(offset - 0x208) >> 3] = value;
-			return 1;
-		}
+		_GAVINWriteTimer(offset,value,size);
+		return 1;
 	}
 	return 0;
 }
@@ -126,22 +132,22 @@ int Gavin_Write(int offset,BYTE8 *memory,int value,int size) {
 
 int GAVIN_InterruptLevel(void) {
 	// Vicky B (6)
-	if (icr[0x00 + 0] & ~icr[0x18 + 0]) {
+	if (machine->icr[0x00 + 0] & ~machine->icr[0x18 + 0]) {
 		return IRQ_VICKY_B;
 	}
 
 	// Vicky A (5)
-	if (icr[0x00 + 1] & ~icr[0x18 + 1]) {
+	if (machine->icr[0x00 + 1] & ~machine->icr[0x18 + 1]) {
 		return IRQ_VICKY_A;
 	}
 
 	// Gavin SuperIO (4)
-	if (icr[0x00 + 3] & ~icr[0x18 + 3]) {
+	if (machine->icr[0x00 + 3] & ~machine->icr[0x18 + 3]) {
 		return IRQ_GAVIN_SUPERIO;
 	}
 
 	// Gavin timer etc (3)
-	if (icr[0x00 + 2] & ~icr[0x18 + 2]) {
+	if (machine->icr[0x00 + 2] & ~machine->icr[0x18 + 2]) {
 		return IRQ_GAVIN_TIMER;
 	}
 
@@ -155,7 +161,7 @@ int GAVIN_InterruptLevel(void) {
 // *******************************************************************************************************************************
 
 void GAVIN_FlagInterrupt(int offset,int bitMask) {
-	icr[offset] |= bitMask;
+	machine->icr[offset] |= bitMask;
 }
 
 // *******************************************************************************************************************************
@@ -165,24 +171,135 @@ void GAVIN_FlagInterrupt(int offset,int bitMask) {
 // *******************************************************************************************************************************
 
 void GAVIN_InsertMauFIFO(int mau) {
-	mauQueue = mau;
+	machine->mauQueue = mau;
+}
+
+// *******************************************************************************************************************************
+//
+//		Timers. 0-2 count CPU cycles and are brought up to date when accessed, an event is scheduled for the cycle they
+//		reach their compare value. 3 and 4 count start of frames. On a match 0-2 clear (up) or reload (down), 3 and 4
+//		do so only if RECLR / RELOAD are set.
+//
+// *******************************************************************************************************************************
+
+static int _GAVINTimerControl(int n) {
+	return (machine->tcr[n / 3] >> ((n % 3) * 8)) & 0xFF;
+}
+
+static void _GAVINSampleTimer(int n,SCHEDTIME now) {
+	if (n < 3 && (_GAVINTimerControl(n) & TCR_ENABLE) != 0) {
+		LONG32 elapsed = (LONG32) (now - machine->timers[n].base);
+		machine->timers[n].value += (_GAVINTimerControl(n) & TCR_CNTUP) ? elapsed : -elapsed;
+	}
+	machine->timers[n].base = now;
+}
+
+static void _GAVINScheduleTimer(int n) {
+	SCHEDCancel(SCHED_TIMER+n);
+	int ctrl = _GAVINTimerControl(n);
+	if (n < 3 && (ctrl & TCR_ENABLE) != 0) {
+		LONG32 distance = (ctrl & TCR_CNTUP) ? machine->timers[n].compare - machine->timers[n].value :
+											   machine->timers[n].value - machine->timers[n].compare;
+		SCHEDPost(SCHED_TIMER+n,machine->timers[n].base + (distance == 0 ? 0x100000000ULL : distance));
+	}
+}
+
+static void _GAVINTimerMatch(int n) {
+	int ctrl = _GAVINTimerControl(n);
+	if (n < 3 || (ctrl & TCR_RECLR) != 0) {
+		if (ctrl & TCR_CNTUP) machine->timers[n].value = 0;
+	}
+	if (n < 3 || (ctrl & TCR_RELOAD) != 0) {
+		if ((ctrl & TCR_CNTUP) == 0) machine->timers[n].value = machine->timers[n].load;
+	}
+	if (ctrl & TCR_INE) {
+		GAVIN_FlagInterrupt(2,1 << n); 												// Bits 0-4 of ICR 2 (Timers)
+		int level = GAVIN_InterruptLevel();
+		if (level != -1) {
+			m68k_set_irq(level);
+		}
+	}
+}
+
+static void _GAVINTimerEvent(int event,SCHEDTIME when) {
+	int n = event - SCHED_TIMER;
+	_GAVINSampleTimer(n,when); 														// Exactly at the compare value.
+	_GAVINTimerMatch(n);
+	_GAVINScheduleTimer(n);
+}
+
+static int _GAVINControlShift(int offset,int size) {								// Big endian, so byte 3 is timer 0.
+	return (4 - size - (offset & 3)) * 8;
+}
+
+static LONG32 _GAVINReadTimer(int offset,int size) {
+	SCHEDTIME now = SCHEDGetTime();
+	if (offset < 0x208) {
+		LONG32 mask = 0xFFFFFFFF >> (32 - size * 8);
+		return (machine->tcr[(offset - 0x200) >> 2] >> _GAVINControlShift(offset,size)) & mask;
+	}
+	int n = (offset - 0x208) >> 3;
+	if (offset & 4) return machine->timers[n].compare;
+	_GAVINSampleTimer(n,now);
+	return machine->timers[n].value;
+}
+
+static void _GAVINWriteTimer(int offset,LONG32 value,int size) {
+	SCHEDTIME now = SCHEDGetTime();
+	if (offset < 0x208) {															// Control register, all or part of it.
+		int r = (offset - 0x200) >> 2;
+		int shift = _GAVINControlShift(offset,size);
+		LONG32 mask = (0xFFFFFFFF >> (32 - size * 8)) << shift;
+		for (int n = r * 3;n < r * 3 + 3 && n < 5;n++) _GAVINSampleTimer(n,now);
+		machine->tcr[r] = (machine->tcr[r] & ~mask) | ((value << shift) & mask);
+		for (int n = r * 3;n < r * 3 + 3 && n < 5;n++) {
+			if (((mask >> ((n % 3) * 8)) & 0xFF) != 0) {							// Clear / Load only if written.
+				if (_GAVINTimerControl(n) & TCR_CLEAR) machine->timers[n].value = 0;
+				if (_GAVINTimerControl(n) & TCR_LOAD) machine->timers[n].value = machine->timers[n].load;
+			}
+			_GAVINScheduleTimer(n);
+		}
+		return;
+	}
+	int n = (offset - 0x208) >> 3;
+	_GAVINSampleTimer(n,now);
+	if (offset & 4) {
+		machine->timers[n].compare = value;
+	} else {
+		machine->timers[n].value = machine->timers[n].load = value;
+	}
+	_GAVINScheduleTimer(n);
 }
 
 // *******************************************************************************************************************************
 //
-//											Update timers, currently free running
+//												Start of frame, update timers 3 and 4
 //
 // *******************************************************************************************************************************
 
-void GAVIN_UpdateTimers(int cycles,int frames) {
-	LONG32 ctrl0 = m68k_read_memory_32(ADDR_GAVIN+0x200);			// Read control registers
-	LONG32 ctrl1 = m68k_read_memory_32(ADDR_GAVIN+0x204);
+void GAVIN_UpdateFrameTimers(void) {
+	for (int n = 3;n < 5;n++) {
+		int ctrl = _GAVINTimerControl(n);
+		if (ctrl & TCR_ENABLE) {
+			machine->timers[n].value += (ctrl & TCR_CNTUP) ? 1 : -1;
+			if (machine->timers[n].value == machine->timers[n].compare) _GAVINTimerMatch(n);
+		}
+	}
+}
 
-	if (ctrl0 & 0x000001) timers[0] += cycles;
-	if (ctrl0 & 0x000100) timers[1] += cycles;
-	if (ctrl0 & 0x010001) timers[2] += cycles;
-	if (ctrl1 & 0x000001) timers[3] += frames;
-	if (ctrl1 & 0x000100) timers[4] += frames;
+// *******************************************************************************************************************************
+//
+//													Reset Gavin timers
+//
+// *******************************************************************************************************************************
+
+void GAVIN_Reset(void) {
+	machine->tcr[0] = machine->tcr[1] = 0;
+	for (int n = 0;n < 5;n++) {
+		machine->timers[n].value = machine->timers[n].compare = machine->timers[n].load = 0;
+		machine->timers[n].base = 0;
+		if (n < 3) SCHEDSetHandler(SCHED_TIMER+n,_GAVINTimerEvent);
+	}
 }
 
 // *******************************************************************************************************************************
@@ -199,7 +316,7 @@ int GAVIN_IdentifyInterrupt(int irq) {
 	}
 	//printf("ICR %d = %x\n",n,icr[n]);
 	int base = (4-irq) * 8; 										// User IRQ vector.
-	int bCheck = icr[n];
+	int bCheck = machine->icr[n];
 	while ((bCheck & 1) == 0) {
 		bCheck >>=1; 												// FInd first set bit.
 		base++;
@@ -217,6 +334,10 @@ int GAVIN_IdentifyInterrupt(int irq) {
 //		Date 			Changes
 //		---- 			-------
 //		11-Mar-22 		Added timer 4 and enable bits.
+//		17-10-2026 		Timers 0-2 are cycle accurate and raise interrupts through the scheduler, control registers decoded.
+//		17-10-2026 		Interrupt and timer registers are in the current MACHINE.
+//		17-10-2026 		RTC runs from the cycle count when recording or replaying.
+//		17-10-2026 		Timer control registers can be written a byte or word at a time.
 //
 // *******************************************************************************************************************************
 // *******************************************************************************************************************************
@@ -11,11 +11,34 @@
 
 #include <includes.h>
 
+#define VICKY_LINES 	(525) 															// Scan lines per frame including blanking.
+
+// *******************************************************************************************************************************
+//										Line interrupt event, flag start of line
+// *******************************************************************************************************************************
+
+static void _HWLineEvent(int event,SCHEDTIME when) {
+	if (event >= SCHED_LINE_B) {
+		GAVIN_FlagInterrupt(0,0x02); 													// Bit 9 of ICR 0 (Vicky B SOL)
+	} else {
+		GAVIN_FlagInterrupt(1,0x02); 													// Bit 1 of ICR 0 (Vicky A SOL)
+	}
+	int level = GAVIN_InterruptLevel();
+	if (level != -1) {
+		m68k_set_irq(level);
+	}
+}
+
 // *******************************************************************************************************************************
 //												Reset Hardware
 // *******************************************************************************************************************************
 
 void HWReset(void) {	
+	GAVIN_Reset();
+	for (int i = 0;i < 3;i++) {
+		SCHEDSetHandler(SCHED_LINE_A+i,_HWLineEvent);
+		SCHEDSetHandler(SCHED_LINE_B+i,_HWLineEvent);
+	}
 }
 
 // *******************************************************************************************************************************
@@ -25,6 +48,27 @@ void HWReset(void) {
 void HWSync(void) {
 }
 
+// *******************************************************************************************************************************
+//		Start of frame. Line interrupt registers are at +$18 in each Vicky, a control word with enable bits 0-2, then
+//		three compare words holding the line number. Each enabled one is scheduled for this frame.
+// *******************************************************************************************************************************
+
+void HWStartFrame(SCHEDTIME frameStart,int frameCycles) {
+	static const LONG32 vicky[2] = { ADDR_VICKY3A,ADDR_VICKY3B };
+	static const int event[2] = { SCHED_LINE_A,SCHED_LINE_B };
+	for (int v = 0;v < 2;v++) {
+		int ctrl = m68k_read_memory_16(vicky[v]+0x18);
+		for (int i = 0;i < 3;i++) {
+			int line = m68k_read_memory_16(vicky[v]+0x1A+i*2) & 0xFFF;
+			if ((ctrl & (1 << i)) != 0 && line < VICKY_LINES) {
+				SCHEDPost(event[v]+i,frameStart + (SCHEDTIME) line * frameCycles / VICKY_LINES);
+			} else {
+				SCHEDCancel(event[v]+i);
+			}
+		}
+	}
+}
+
 // *******************************************************************************************************************************
 //											   Handle Keystrokes
 // *******************************************************************************************************************************
@@ -37,7 +81,7 @@ void  HWScanCodeHandler(int scancode,int keydown) {
 		scancode == SDL_SCANCODE_F5 || scancode == SDL_SCANCODE_F6 || scancode == SDL_SCANCODE_F7 || scancode == SDL_SCANCODE_F8 ||
 		scancode == SDL_SCANCODE_F9 || scancode == SDL_SCANCODE_F10) return;
 
-	if (DBGGetRunMode() == 0) return;
+	if (DBGGetRunMode() == 0 || REPLAYIsPlaying()) return;							// Replays have their own keys.
 
 	int n = 0;
 	while (mau_table[n] != -1 && mau_table[n] != scancode) {
@@ -45,13 +89,22 @@ void  HWScanCodeHandler(int scancode,int keydown) {
 	}
 	if (mau_table[n] == scancode && mau_table[n] != 0 && mau_table[n] != 0x80) {		
 		int mau = n | (keydown ? 0x00:0x80);
-		GAVIN_InsertMauFIFO(mau);
-		GAVIN_FlagInterrupt(3,0x02); 							 						// Bit 1 of ICR 1 (Gavin SuperIO)		
+		REPLAYKey(mau);
+		HWKeyEvent(mau);
+	}
+}
 
-		int level = GAVIN_InterruptLevel();
-		if (level != -1) {
-			m68k_set_irq(level);
-		}
+// *******************************************************************************************************************************
+//								Pass a MAU key code to the machine, from the host or a replay
+// *******************************************************************************************************************************
+
+void HWKeyEvent(int mau) {
+	GAVIN_InsertMauFIFO(mau);
+	GAVIN_FlagInterrupt(3,0x02); 							 						// Bit 1 of ICR 1 (Gavin SuperIO)		
+
+	int level = GAVIN_InterruptLevel();
+	if (level != -1) {
+		m68k_set_irq(level);
 	}
 }
 
@@ -62,6 +115,8 @@ void  HWScanCodeHandler(int scancode,int keydown) {
 //	
 //		Date 			Changes
 //		---- 			-------
+//		17-10-2026 		Vicky line interrupts are scheduled at the start of each frame.
+//		17-10-2026 		Keys can be recorded and replayed.
 //
 // *******************************************************************************************************************************
 // *******************************************************************************************************************************
@@ -0,0 +1,101 @@
+// *******************************************************************************************************************************
+// *******************************************************************************************************************************
+//
+//		Name:		machine.cpp
+//		Purpose:	Emulated machine instance
+//		Created:	17th October 2026
+//		Author:		agent (agent@local)
+//
+//		The CPU core keeps its registers per thread. A thread running one machine leaves them there, one switching
+//		between machines swaps them in and out of each machine's context buffer.
+//
+// *******************************************************************************************************************************
+// *******************************************************************************************************************************
+
+#include <includes.h>
+
+M68K_THREAD_LOCAL MACHINE *machine = NULL;
+
+// *******************************************************************************************************************************
+//		Create a machine. It is cleared, not reset, CPUReset() does that once it has been selected. Memory regions are
+//		zero until written, so the unused parts of them, most of the SDRAM usually, are never committed.
+// *******************************************************************************************************************************
+
+MACHINE *MACHINECreate(void) {
+	MACHINE *m = (MACHINE *) calloc(1,sizeof(MACHINE));
+	if (m == NULL)
+		exit(fprintf(stderr,"Out of memory for machine"));
+	m->ramMemory = MEMCreateRegion(SRAM_END,0);
+	m->flashMemory = MEMCreateRegion(FLASH_SIZE,0);
+	m->videoMemory = MEMCreateRegion(VRAM_SIZE,1);
+	m->hwMemory = MEMCreateRegion(HARDWARE_RAM,0);
+	#ifdef SDRAM_ENABLED
+	m->sdMemory = MEMCreateRegion(SDRAM_SIZE,1);
+	#endif
+	m->breakSet = new std::unordered_set<LONG32>();
+	m->symbols = new FFMTSYMBOLS();
+	m->cpuContext = malloc(m68k_context_size());
+	m->logBadAddress = 0;
+	m->idleReads = 1;
+	for (int i = 0;i < SCHED_EVENTS;i++) m->eventSlot[i] = -1;
+	return m;
+}
+
+// *******************************************************************************************************************************
+//													Destroy a machine
+// *******************************************************************************************************************************
+
+void MACHINEDestroy(MACHINE *m) {
+	if (m == machine) MACHINESelect(NULL);
+	MEMDestroyRegion(m->ramMemory,SRAM_END);
+	MEMDestroyRegion(m->flashMemory,FLASH_SIZE);
+	MEMDestroyRegion(m->videoMemory,VRAM_SIZE);
+	MEMDestroyRegion(m->hwMemory,HARDWARE_RAM);
+	#ifdef SDRAM_ENABLED
+	MEMDestroyRegion(m->sdMemory,SDRAM_SIZE);
+	#endif
+	delete m->breakSet;
+	delete m->symbols;
+	delete m->rewind;
+	if (m->replay != NULL && m->replay->file != NULL) fclose(m->replay->file);
+	delete m->replay;
+	free(m->cpuContext);
+	free(m);
+}
+
+// *******************************************************************************************************************************
+//		Make m the current machine on this thread, NULL for none. The CPU is switched over too, its cached blocks and
+//		any idle loop it was watching belong to the old machine.
+// *******************************************************************************************************************************
+
+void MACHINESelect(MACHINE *m) {
+	if (m == machine) return;
+	if (machine != NULL) { 															// Put away the old CPU.
+		m68k_get_context(machine->cpuContext);
+		machine->cpuSaved = 1;
+	}
+	machine = m;
+	CPUBreakPages = (m != NULL) ? m->breakPages : NULL;
+	if (m != NULL && m->cpuSaved) { 												// And bring back the new one.
+		m68k_set_context(m->cpuContext);
+	} else {
+		m68k_flush_fetch_pointer();
+		m68k_flush_code_cache();
+	}
+	m68k_forget_idle_loop();
+}
+
+// *******************************************************************************************************************************
+// *******************************************************************************************************************************
+//
+//		Changes made
+//
+//		Date 			Changes
+//		---- 			-------
+//		17-10-2026 		Rewind history and input recording are freed with the machine.
+//		17-10-2026 		Memory is in regions from memory.cpp.
+//		17-10-2026 		Symbols loaded from ELF files belong to the machine.
+//		18-10-2026 		The CPU core builds its opcode table itself, from m68k_init() in CPUReset().
+//
+// *******************************************************************************************************************************
+// *******************************************************************************************************************************
@@ -11,16 +11,15 @@
 
 #include <includes.h>
 
-static BYTE8 ramMemory[SRAM_END];													// SRAM Memory at $000000
-static BYTE8 flashMemory[FLASH_SIZE];												// Flash memory at end of memory
-static BYTE8 videoMemory[VRAM_END-VRAM_START+1];									// Video RAM
-static BYTE8 hwMemory[HARDWARE_RAM]; 												// RAM space & Registers in hardware area
-static int   logBadAddress = 0; 													// Log address errors.
-
-#ifdef SDRAM_ENABLED
-static BYTE8 sdMemory[64*1024*1024];												// 64 Mb SDRAM.
+#ifdef LINUX
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 #endif
 
+#define MEM_HUGE_PAGE 	(2*1024*1024)												// Host huge page size regions are aligned to.
+
 // *******************************************************************************************************************************
 //													  Print logged text
 // *******************************************************************************************************************************
@@ -40,7 +39,290 @@ static void logPrint(unsigned int textAddr) {
 // *******************************************************************************************************************************
 
 void MEMSetAddressLog(int logBad) {
-	logBadAddress = logBad;
+	machine->logBadAddress = logBad;
+}
+
+// *******************************************************************************************************************************
+//										Map host memory into the page tables
+// *******************************************************************************************************************************
+
+static void _MEMMapPages(LONG32 start,LONG32 size,BYTE8 *host,int writeable) {
+	for (LONG32 offset = 0;offset < size;offset += (1 << MEM_PAGE_SHIFT)) {
+		LONG32 page = (start + offset) >> MEM_PAGE_SHIFT;
+		machine->readPage[page] = host + offset;
+		machine->writePage[page] = machine->writeHost[page] = writeable ? host + offset : NULL;
+	}
+}
+
+static void _MEMClear(void *block,size_t size) {									// Only the parts not already zero, so
+	static const BYTE8 zero[4096] = { 0 };											// host pages never used aren't committed.
+	for (size_t offset = 0;offset < size;offset += sizeof(zero)) {
+		size_t n = std::min(size-offset,sizeof(zero));
+		if (memcmp((BYTE8 *) block+offset,zero,n) != 0) memset((BYTE8 *) block+offset,0,n);
+	}
+}
+
+static void _MEMBuildPageTable(void) {
+	_MEMClear(machine->readPage,sizeof(machine->readPage));
+	_MEMClear(machine->writePage,sizeof(machine->writePage));
+	_MEMClear(machine->writeHost,sizeof(machine->writeHost));
+	_MEMClear(machine->codeChunk,sizeof(machine->codeChunk));
+	machine->dirtyTracking = 0;
+	_MEMMapPages(0,SRAM_END,machine->ramMemory,1);
+	_MEMMapPages(VRAM_START,VRAM_SIZE,machine->videoMemory,1);
+	_MEMMapPages(FLASH_ADDRESS,FLASH_SIZE,machine->flashMemory,0);					// Writes are ignored by device code.
+	#ifdef SDRAM_ENABLED
+	_MEMMapPages(SDRAM_ADDRESS,SDRAM_SIZE,machine->sdMemory,1);
+	#endif
+	for (LONG32 a = 0;a < HARDWARE_RAM;a += (1 << MEM_PAGE_SHIFT)) { 				// Hardware pages without intercepts.
+		if (!ISHWINTERCEPT(HARDWARE_START+a)) {
+			_MEMMapPages(HARDWARE_START+a,1 << MEM_PAGE_SHIFT,machine->hwMemory+a,1);
+		}
+	}
+	m68k_flush_fetch_pointer(); 													// CPU may have a stale fetch pointer.
+	m68k_flush_code_cache(); 														// and stale cached blocks.
+}
+
+// *******************************************************************************************************************************
+//		The CPU is caching the opcode at address. Pages holding cached code are written through the device code path so
+//		the cache can be told. Returns 0 if the address isn't host memory and can't be cached.
+// *******************************************************************************************************************************
+
+#define ISCODECHUNK(a) 	(machine->codeChunk[(a) >> (MEM_CODE_SHIFT+3)] & (1 << (((a) >> MEM_CODE_SHIFT) & 7)))
+
+int MEMMarkCode(unsigned int address) {
+	address &= ADDRESS_MASK;
+	LONG32 page = address >> MEM_PAGE_SHIFT;
+	if (machine->readPage[page] == NULL) return 0;
+	if (machine->writeHost[page] == NULL) return 1;									// Flash, the CPU can't change it.
+	for (LONG32 a = address;a <= address+1;a++) { 									// Both bytes of the opcode.
+		machine->codeChunk[a >> (MEM_CODE_SHIFT+3)] |= (1 << ((a >> MEM_CODE_SHIFT) & 7));
+	}
+	machine->writePage[page] = NULL;
+	return 1;
+}
+
+// *******************************************************************************************************************************
+//		Written pages are tracked, for rewinding. MEMClearDirty() takes the RAM pages out of the write page table, so
+//		the first write to each comes through _MEMWriteCode(), which marks it and puts it back unless it holds code.
+//		Rebuilding the page table stops the tracking.
+// *******************************************************************************************************************************
+
+#define ISDIRTY(p) 		(machine->dirtyPage[(p) >> 3] & (1 << ((p) & 7)))
+
+static int _MEMHasCode(LONG32 page) {
+	BYTE8 *chunks = machine->codeChunk + (page << (MEM_PAGE_SHIFT-MEM_CODE_SHIFT-3));
+	for (int i = 0;i < (1 << (MEM_PAGE_SHIFT-MEM_CODE_SHIFT-3));i++) {
+		if (chunks[i] != 0) return 1;
+	}
+	return 0;
+}
+
+static void _MEMMarkDirty(unsigned int address,int size) {
+	for (LONG32 page = address >> MEM_PAGE_SHIFT;page <= (address+size-1) >> MEM_PAGE_SHIFT;page++) {
+		if (!ISDIRTY(page)) {
+			machine->dirtyPage[page >> 3] |= (1 << (page & 7));
+			if (!_MEMHasCode(page)) machine->writePage[page] = machine->writeHost[page];
+		}
+	}
+}
+
+void MEMClearDirty(void) {
+	memset(machine->dirtyPage,0,sizeof(machine->dirtyPage));
+	for (LONG32 page = 0;page < MEM_PAGES;page++) {
+		if (machine->writeHost[page] != NULL) machine->writePage[page] = NULL;
+	}
+	machine->dirtyTracking = 1;
+}
+
+int MEMIsTracking(void) {
+	return machine->dirtyTracking;
+}
+
+// *******************************************************************************************************************************
+//		Host memory for a page of RAM, including the hardware area, NULL if it is Flash or unused. MEMGetDirtyPage()
+//		only returns it if it was written since MEMClearDirty(). Hardware pages with device registers are written by
+//		the device code, so they always count as written.
+// *******************************************************************************************************************************
+
+BYTE8 *MEMGetRAMPage(LONG32 page) {
+	LONG32 address = page << MEM_PAGE_SHIFT;
+	if (ISHWADDR(address)) return machine->hwMemory + (address - HARDWARE_START);
+	return machine->writeHost[page];
+}
+
+BYTE8 *MEMGetDirtyPage(LONG32 page) {
+	LONG32 address = page << MEM_PAGE_SHIFT;
+	if (ISHWADDR(address) && ISHWINTERCEPT(address)) return MEMGetRAMPage(page);
+	return ISDIRTY(page) ? MEMGetRAMPage(page) : NULL;
+}
+
+// *******************************************************************************************************************************
+//		Write to a page holding cached code, or one not yet marked as written, dropping cached blocks in any chunk
+//		written. Returns the host memory for the page, NULL if it isn't one.
+// *******************************************************************************************************************************
+
+static BYTE8 *_MEMWriteCode(unsigned int address,int size) {
+	BYTE8 *p = machine->writeHost[address >> MEM_PAGE_SHIFT];
+	if (p != NULL) {
+		_MEMMarkDirty(address,size);
+		for (LONG32 a = address & ~((1 << MEM_CODE_SHIFT)-1);a < address+size;a += (1 << MEM_CODE_SHIFT)) {
+			if (ISCODECHUNK(a)) {
+				machine->codeChunk[a >> (MEM_CODE_SHIFT+3)] &= ~(1 << ((a >> MEM_CODE_SHIFT) & 7));
+				m68k_invalidate_code(a,1 << MEM_CODE_SHIFT);
+			}
+		}
+	}
+	return p;
+}
+
+// *******************************************************************************************************************************
+//		Device registers a polling loop may read and still be idle : they only change when a scheduled event runs
+//		(or, for the MAU, when the frame event passes on a key). Anything else in the device area, the timers and
+//		the RTC especially, moves on by itself, so a loop reading it has to be run.
+// *******************************************************************************************************************************
+
+static const LONG32 idlePollable[][2] = {
+	{ ADDR_GAVIN+0x40,ADDR_GAVIN+0x43 }, 												// MAU FIFO (keyboard)
+	{ ADDR_GAVIN+0x100,ADDR_GAVIN+0x11F }, 											// Interrupt pending and mask
+	{ ADDR_GAVIN+0x2060,ADDR_GAVIN+0x2067 } 											// PS/2 port, always zero.
+};
+
+static void _MEMCheckIdleRead(unsigned int address) {
+	for (unsigned int i = 0;i < sizeof(idlePollable)/sizeof(idlePollable[0]);i++) {
+		if (address >= idlePollable[i][0] && address <= idlePollable[i][1]) return;
+	}
+	machine->idleReads = 0;
+}
+
+// *******************************************************************************************************************************
+//		Called by the CPU each time round a loop which may be idle. Returns non zero if every read since the last call
+//		would read the same again, until an event. Plain memory is fine, the CPU counts writes itself.
+// *******************************************************************************************************************************
+
+int MEMIdleReads(void) {
+	int repeats = machine->idleReads;
+	machine->idleReads = 1;
+	return repeats;
+}
+
+// *******************************************************************************************************************************
+//		Host memory for instruction fetch, the mapped page holding address extended over neighbouring pages that
+//		are contiguous in host memory, up to 1Mb. NULL if not mapped.
+// *******************************************************************************************************************************
+
+#define MEM_FETCH_PAGES (16)
+
+const unsigned char *MEMGetFetchPointer(unsigned int address,unsigned int *start,unsigned int *size) {
+	LONG32 page = (address & ADDRESS_MASK) >> MEM_PAGE_SHIFT;
+	BYTE8 *p = machine->readPage[page];
+	if (p == NULL) return NULL;
+	LONG32 first = page,last = page;
+	while (first > 0 && page-first < MEM_FETCH_PAGES && 							// Extend downwards
+					machine->readPage[first-1] == machine->readPage[first] - (1 << MEM_PAGE_SHIFT)) first--;
+	while (last < MEM_PAGES-1 && last-page < MEM_FETCH_PAGES && 					// Extend upwards
+					machine->readPage[last+1] == machine->readPage[last] + (1 << MEM_PAGE_SHIFT)) last++;
+	*start = first << MEM_PAGE_SHIFT;
+	*size = (last-first+1) << MEM_PAGE_SHIFT;
+	return machine->readPage[first];
+}
+
+// *******************************************************************************************************************************
+//		Host memory for a block move by the CPU, NULL unless address to address+size-1 is mapped pages all in one host
+//		array. Cached code in a range about to be written is dropped, as it is by a write.
+// *******************************************************************************************************************************
+
+unsigned char *MEMGetHostPointer(unsigned int address,unsigned int size,int write) {
+	address &= ADDRESS_MASK;
+	if (size == 0 || address+size-1 < address) return NULL; 						// Wraps round.
+	BYTE8 **table = write ? machine->writeHost : machine->readPage;
+	LONG32 first = address >> MEM_PAGE_SHIFT,last = (address+size-1) >> MEM_PAGE_SHIFT;
+	if (table[first] == NULL) return NULL;
+	for (LONG32 page = first;page < last;page++) {
+		if (table[page+1] != table[page] + (1 << MEM_PAGE_SHIFT)) return NULL;
+	}
+	if (write) _MEMWriteCode(address,size);
+	return table[first] + (address & MEM_PAGE_MASK);
+}
+
+// *******************************************************************************************************************************
+//		Write a block loaded from a file. Copied straight into mapped memory a page at a time, anything else is
+//		written through the device code a byte at a time.
+// *******************************************************************************************************************************
+
+void MEMWriteBlock(LONG32 address,const BYTE8 *data,LONG32 size) {
+	while (size > 0) {
+		LONG32 n = std::min(size,(LONG32) (1 << MEM_PAGE_SHIFT) - (address & MEM_PAGE_MASK));
+		BYTE8 *host = MEMGetHostPointer(address,n,1);
+		if (host != NULL) {
+			memcpy(host,data,n);
+		} else {
+			for (LONG32 i = 0;i < n;i++) m68k_write_memory_8(address+i,data[i]);
+		}
+		address += n;data += n;size -= n;
+	}
+}
+
+// *******************************************************************************************************************************
+//		Guest memory regions. Anonymous mappings, zero until written, so the host only commits the pages the machine
+//		uses. Large ones read right through, video RAM by the renderer, can ask for huge pages, fewer TLB misses but
+//		2Mb committed at a time. Hosts without mmap get zeroed allocations.
+// *******************************************************************************************************************************
+
+BYTE8 *MEMCreateRegion(LONG32 size,int huge) {
+	#ifdef LINUX
+	size_t span = (size_t) size + MEM_HUGE_PAGE;
+	BYTE8 *base = (BYTE8 *) mmap(NULL,span,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS,-1,0);
+	if (base == (BYTE8 *) MAP_FAILED)
+		exit(fprintf(stderr,"Out of memory for machine"));
+	BYTE8 *region = (BYTE8 *) (((uintptr_t) base + MEM_HUGE_PAGE-1) & ~(uintptr_t) (MEM_HUGE_PAGE-1));
+	if (region != base) munmap(base,region-base); 									// Trim to the aligned part.
+	munmap(region+size,base+span-(region+size));
+	#ifdef MADV_HUGEPAGE
+	if (huge) madvise(region,size,MADV_HUGEPAGE);
+	#endif
+	#else
+	BYTE8 *region = (BYTE8 *) calloc(1,size);
+	if (region == NULL)
+		exit(fprintf(stderr,"Out of memory for machine"));
+	#endif
+	return region;
+}
+
+void MEMDestroyRegion(BYTE8 *region,LONG32 size) {
+	#ifdef LINUX
+	if (region != NULL) munmap(region,size);
+	#else
+	free(region);
+	#endif
+}
+
+// *******************************************************************************************************************************
+//		Flash ROM mapped from the file, private so writes are the machine's own. Returns zero if it can't be, in which
+//		case it's read in.
+// *******************************************************************************************************************************
+
+static int _MEMMapFlashROM(void) {
+	#ifdef LINUX
+	int fd = open(FLASH_ROM,O_RDONLY);
+	if (fd < 0) return 0;
+	struct stat st;
+	size_t pageSize = (size_t) sysconf(_SC_PAGESIZE);
+	size_t size = (fstat(fd,&st) == 0) ? std::min((size_t) st.st_size,(size_t) FLASH_SIZE) : 0;
+	size = (size + pageSize-1) / pageSize * pageSize;								// The file's last page is zero filled,
+	BYTE8 *flash = MEMCreateRegion(FLASH_SIZE,0);									// past that it is the region's zeroes.
+	int ok = size != 0 && mmap(flash,size,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_FIXED,fd,0) != MAP_FAILED;
+	close(fd);
+	if (!ok) {
+		MEMDestroyRegion(flash,FLASH_SIZE);
+		return 0;
+	}
+	MEMDestroyRegion(machine->flashMemory,FLASH_SIZE); 								// Also drops any earlier writes.
+	machine->flashMemory = flash;
+	return 1;
+	#else
+	return 0;
+	#endif
 }
 
 // *******************************************************************************************************************************
@@ -48,14 +330,17 @@ void MEMSetAddressLog(int logBad) {
 // *******************************************************************************************************************************
 
 void MEMLoadFlashROM(void) {
-	FILE *f = fopen(FLASH_ROM,"rb"); 												// Read Flash ROM
-	if (f == NULL)
-		exit(fprintf(stderr,"Flash rom %s missing",FLASH_ROM));
-	fread(flashMemory,1,sizeof(flashMemory),f);
-	fclose(f);	
+	if (!_MEMMapFlashROM()) {
+		FILE *f = fopen(FLASH_ROM,"rb"); 											// Read Flash ROM
+		if (f == NULL)
+			exit(fprintf(stderr,"Flash rom %s missing",FLASH_ROM));
+		fread(machine->flashMemory,1,FLASH_SIZE,f);
+		fclose(f);	
+	}
 	for (int i = 0;i < 64*1024;i++) { 												// Copy first 64k to SRAM
-		ramMemory[i] = flashMemory[i];
+		machine->ramMemory[i] = machine->flashMemory[i];
 	}
+	_MEMBuildPageTable();
 }
 
 // *******************************************************************************************************************************
@@ -64,7 +349,7 @@ void MEMLoadFlashROM(void) {
 
 void MEMEndRun(void) {
 	FILE *f = fopen("memory.dump","wb");
-	fwrite(ramMemory,1,sizeof(ramMemory),f);
+	fwrite(machine->ramMemory,1,SRAM_END,f);
 	fclose(f);
 }
 
@@ -79,59 +364,57 @@ void MEMRenderDisplay(int scale) {
 	rc.x = WIN_WIDTH*scale/2 - rc.w/2; rc.y = WIN_HEIGHT*scale/2 - rc.h/2;
 	 													
 	if (GFXGetDisplayToggle() & 1) {
-		HWGetDisplayInfo(&di,'A',hwMemory+0x40000,&rc);
-		HWRenderTextScreen(&di,hwMemory+0x40000,hwMemory+0x60000,hwMemory+0x68000,
-															hwMemory+0x6C400,hwMemory+0x48000);	
+		HWGetDisplayInfo(&di,'A',machine->hwMemory+0x40000,&rc);
+		HWRenderTextScreen(&di,machine->hwMemory+0x40000,machine->hwMemory+0x60000,machine->hwMemory+0x68000,
+															machine->hwMemory+0x6C400,machine->hwMemory+0x48000);	
 	} else {
-		HWGetDisplayInfo(&di,'B',hwMemory+0x80000,&rc);
-		HWRenderBitmap(&di,hwMemory+0x80000,videoMemory,0);
-		HWRenderTextScreen(&di,hwMemory+0x80000,hwMemory+0xA0000,hwMemory+0xA8000,
-															hwMemory+0xAC400,hwMemory+0x88000);
+		HWGetDisplayInfo(&di,'B',machine->hwMemory+0x80000,&rc);
+		HWRenderBitmap(&di,machine->hwMemory+0x80000,machine->videoMemory,0);
+		HWRenderTextScreen(&di,machine->hwMemory+0x80000,machine->hwMemory+0xA0000,machine->hwMemory+0xA8000,
+															machine->hwMemory+0xAC400,machine->hwMemory+0x88000);
 	}
 }
 
 // *******************************************************************************************************************************
-//													  Generic read routines
+//						Generic read routines, used for pages that aren't mapped to host memory.
 // *******************************************************************************************************************************
 
-unsigned int  m68k_read_memory_8(unsigned int address){
-
-	address &= ADDRESS_MASK;
+static unsigned int _MEMReadByte(unsigned int address){
 
 	if (address < SRAM_END) {
-		return ramMemory[address];
+		return machine->ramMemory[address];
 	}
 
 	if (address >= FLASH_ADDRESS) {
-		return flashMemory[address & (FLASH_SIZE-1)];
+		return machine->flashMemory[address & (FLASH_SIZE-1)];
 	}
 
 	if (address >= VRAM_START && address <= VRAM_END) {
-		return videoMemory[address-VRAM_START];
+		return machine->videoMemory[address-VRAM_START];
 	}
 
 	#ifdef SDRAM_ENABLED
 	if (address >= SDRAM_ADDRESS && address < SDRAM_ADDRESS+0x4000000) {
-		return sdMemory[address-SDRAM_ADDRESS];
+		return machine->sdMemory[address-SDRAM_ADDRESS];
 	}
 	#endif
 
 	if (ISHWADDR(address)) {
+		_MEMCheckIdleRead(address);
 		#include "generated/hardware/hw_gavin_read_byte.h"
 		#include "generated/hardware/hw_beatrix_read_byte.h"
 		#include "generated/hardware/hw_vicky3a_read_byte.h"
 		#include "generated/hardware/hw_vicky3b_read_byte.h"
-		return hwMemory[address-HARDWARE_START];
+		return machine->hwMemory[address-HARDWARE_START];
 	}
-	if (logBadAddress) printf("Warning: Reading address $%08x PC:$%08x\n",address,PC);
+	if (machine->logBadAddress) printf("Warning: Reading address $%08x PC:$%08x\n",address,PC);
 	return 0x00;
 }
 
-unsigned int  m68k_read_memory_16(unsigned int address){
-
-	address &= ADDRESS_MASK;
+static unsigned int _MEMReadWord(unsigned int address){
 
 	if (ISHWADDR(address)) {
+		_MEMCheckIdleRead(address);
 		#include "generated/hardware/hw_gavin_read_word.h"
 		#include "generated/hardware/hw_beatrix_read_word.h"
 		#include "generated/hardware/hw_vicky3a_read_word.h"
@@ -140,11 +423,10 @@ unsigned int  m68k_read_memory_16(unsigned int address){
 	return m68k_read_memory_8(address+1) + (m68k_read_memory_8(address) << 8);
 }
 
-unsigned int  m68k_read_memory_32(unsigned int address){
-
-	address &= ADDRESS_MASK;
+static unsigned int _MEMReadLong(unsigned int address){
 
 	if (ISHWADDR(address)) {
+		_MEMCheckIdleRead(address);
 		#include "generated/hardware/hw_gavin_read_long.h"
 		#include "generated/hardware/hw_beatrix_read_long.h"
 		#include "generated/hardware/hw_vicky3a_read_long.h"
@@ -155,20 +437,18 @@ unsigned int  m68k_read_memory_32(unsigned int address){
 }
 
 // *******************************************************************************************************************************
-//													 Generic write routines
+//						Generic write routines, used for pages that aren't mapped to host memory.
 // *******************************************************************************************************************************
 
-void m68k_write_memory_8(unsigned int address, unsigned int value){
-
-	address &= ADDRESS_MASK;
+static void _MEMWriteByte(unsigned int address, unsigned int value){
 
 	if (address < SRAM_END) {
-		ramMemory[address] = value & 0xFF;
+		machine->ramMemory[address] = value & 0xFF;
 		return;
 	}
 
 	if (address >= VRAM_START && address <= VRAM_END) {
-		videoMemory[address-VRAM_START] = value;
+		machine->videoMemory[address-VRAM_START] = value;
 		return;
 	}
 
@@ -178,7 +458,7 @@ void m68k_write_memory_8(unsigned int address, unsigned int value){
 
 	#ifdef SDRAM_ENABLED
 	if (address >= SDRAM_ADDRESS && address < SDRAM_ADDRESS+0x4000000) {
-		sdMemory[address-SDRAM_ADDRESS] = value;
+		machine->sdMemory[address-SDRAM_ADDRESS] = value;
 		return;
 	}
 	#endif
@@ -188,15 +468,13 @@ void m68k_write_memory_8(unsigned int address, unsigned int value){
 		#include "generated/hardware/hw_beatrix_write_byte.h"
 		#include "generated/hardware/hw_vicky3a_write_byte.h"
 		#include "generated/hardware/hw_vicky3b_write_byte.h"
-		hwMemory[address-HARDWARE_START] = value;
+		machine->hwMemory[address-HARDWARE_START] = value;
 		return;
 	}
-	if (logBadAddress) printf("Warning: Writing address $%08x PC:$%08x\n",address,PC);
+	if (machine->logBadAddress) printf("Warning: Writing address $%08x PC:$%08x\n",address,PC);
 }
 
-void m68k_write_memory_16(unsigned int address, unsigned int value){
-
-	address &= ADDRESS_MASK;
+static void _MEMWriteWord(unsigned int address, unsigned int value){
 
 	if (ISHWADDR(address)) {
 		#include "generated/hardware/hw_gavin_write_word.h"
@@ -208,9 +486,7 @@ void m68k_write_memory_16(unsigned int address, unsigned int value){
 	m68k_write_memory_8(address,value >> 8);
 }
 
-void m68k_write_memory_32(unsigned int address, unsigned int value){
-
-	address &= ADDRESS_MASK;
+static void _MEMWriteLong(unsigned int address, unsigned int value){
 
 	if (address == 0xFFFFFFFC) {
 		logPrint(value);
@@ -227,6 +503,70 @@ void m68k_write_memory_32(unsigned int address, unsigned int value){
 	m68k_write_memory_16(address,value >> 16);
 }
 
+// *******************************************************************************************************************************
+//		Memory access through the page tables. Words and longs within a mapped page are a single big endian access,
+//		anything else goes to the device code.
+// *******************************************************************************************************************************
+
+unsigned int  m68k_read_memory_8(unsigned int address){
+	address &= ADDRESS_MASK;
+	BYTE8 *p = machine->readPage[address >> MEM_PAGE_SHIFT];
+	if (p != NULL) return p[address & MEM_PAGE_MASK];
+	return _MEMReadByte(address);
+}
+
+unsigned int  m68k_read_memory_16(unsigned int address){
+	address &= ADDRESS_MASK;
+	BYTE8 *p = machine->readPage[address >> MEM_PAGE_SHIFT];
+	if (p != NULL && (address & MEM_PAGE_MASK) <= MEM_PAGE_MASK-1) {
+		p += address & MEM_PAGE_MASK;
+		return (p[0] << 8) | p[1];
+	}
+	return _MEMReadWord(address);
+}
+
+unsigned int  m68k_read_memory_32(unsigned int address){
+	address &= ADDRESS_MASK;
+	BYTE8 *p = machine->readPage[address >> MEM_PAGE_SHIFT];
+	if (p != NULL && (address & MEM_PAGE_MASK) <= MEM_PAGE_MASK-3) {
+		p += address & MEM_PAGE_MASK;
+		return (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+	}
+	return _MEMReadLong(address);
+}
+
+void m68k_write_memory_8(unsigned int address, unsigned int value){
+	address &= ADDRESS_MASK;
+	BYTE8 *p = machine->writePage[address >> MEM_PAGE_SHIFT];
+	if (p == NULL) p = _MEMWriteCode(address,1);
+	if (p != NULL) { p[address & MEM_PAGE_MASK] = value;return; }
+	_MEMWriteByte(address,value);
+}
+
+void m68k_write_memory_16(unsigned int address, unsigned int value){
+	address &= ADDRESS_MASK;
+	BYTE8 *p = machine->writePage[address >> MEM_PAGE_SHIFT];
+	if (p == NULL) p = _MEMWriteCode(address,2);
+	if (p != NULL && (address & MEM_PAGE_MASK) <= MEM_PAGE_MASK-1) {
+		p += address & MEM_PAGE_MASK;
+		p[0] = value >> 8;p[1] = value;
+		return;
+	}
+	_MEMWriteWord(address,value);
+}
+
+void m68k_write_memory_32(unsigned int address, unsigned int value){
+	address &= ADDRESS_MASK;
+	BYTE8 *p = machine->writePage[address >> MEM_PAGE_SHIFT];
+	if (p == NULL) p = _MEMWriteCode(address,4);
+	if (p != NULL && (address & MEM_PAGE_MASK) <= MEM_PAGE_MASK-3) {
+		p += address & MEM_PAGE_MASK;
+		p[0] = value >> 24;p[1] = value >> 16;p[2] = value >> 8;p[3] = value;
+		return;
+	}
+	_MEMWriteLong(address,value);
+}
+
 // *******************************************************************************************************************************
 //							Duplicate R/W routines required by the CPU core for some reason
 // *******************************************************************************************************************************
@@ -261,6 +601,15 @@ unsigned int m68k_read_disassembler_32 (unsigned int address){
 // 		10-03-2022  	Printing by write logging to $FFFFFFFFC (-4) does not trigger warnings.
 //		11-03-2022 		Can write to flash, which does nothing, but doesn't warn.
 //						Added 64Mb of SDRAM support.
+//		17-10-2026 		Accesses dispatched through a table of 64k pages, device code only for unmapped pages.
+//		17-10-2026 		Host pointers for the CPU's instruction fetch.
+//		17-10-2026 		Pages holding cached CPU blocks are written through a check that invalidates them.
+//		17-10-2026 		Device reads are checked against the registers a polling loop can read and still be idle.
+//		17-10-2026 		Host pointers for the CPU's block moves.
+//		17-10-2026 		Memory and page tables are in the current MACHINE.
+//		17-10-2026 		Pages written can be tracked.
+//		17-10-2026 		Memory regions are anonymous mappings, Flash is mapped from the ROM file.
+//		17-10-2026 		Blocks can be written straight into memory by the loaders.
 //
 // *******************************************************************************************************************************
 // *******************************************************************************************************************************
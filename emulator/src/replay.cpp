@@ -0,0 +1,239 @@
+// *******************************************************************************************************************************
+// *******************************************************************************************************************************
+//
+//		Name:		replay.cpp
+//		Purpose:	Input recording and replay
+//		Created:	17th October 2026
+//		Author:		agent (agent@local)
+//
+//		A recording logs each input with the cycle count it reached the machine at, and while recording or replaying
+//		the RTC runs from the cycle count too. Replaying posts each input as a scheduler event at its cycle, so the
+//		slices run, and so everything else, are the same as when it was recorded. Host keys are ignored meanwhile.
+//		The log ends with a hash of the machine, which the replay checks when it gets there.
+//
+// *******************************************************************************************************************************
+// *******************************************************************************************************************************
+
+#include <includes.h>
+
+static const char replayMagic[8] = "F68REC";
+
+// *******************************************************************************************************************************
+//		Hash of the registers, the cycle count, the clock and all the memory, the guest's view of the machine. Not a
+//		snapshot, the slice the CPU was in and how it was cut short aren't part of it.
+// *******************************************************************************************************************************
+
+static unsigned long long _REPLAYHash(void) {
+	static const m68k_register_t regs[] = {
+		M68K_REG_D0,M68K_REG_D1,M68K_REG_D2,M68K_REG_D3,M68K_REG_D4,M68K_REG_D5,M68K_REG_D6,M68K_REG_D7,
+		M68K_REG_A0,M68K_REG_A1,M68K_REG_A2,M68K_REG_A3,M68K_REG_A4,M68K_REG_A5,M68K_REG_A6,M68K_REG_A7,
+		M68K_REG_PC,M68K_REG_SR,M68K_REG_USP,M68K_REG_ISP,M68K_REG_MSP,M68K_REG_VBR
+	};
+	std::vector<LONG32> cpu;
+	for (m68k_register_t r : regs) cpu.push_back(m68k_get_reg(NULL,r));
+	unsigned long long hash = SNAPHash((BYTE8 *) cpu.data(),cpu.size() * sizeof(LONG32));
+	hash = hash * 31 + SCHEDGetTime();
+	hash = hash * 31 + CPUGetClock();
+	for (LONG32 page = 0;page < MEM_PAGES;page++) {
+		BYTE8 *host = MEMGetRAMPage(page);
+		if (host != NULL) hash = hash * 31 + SNAPHash(host,MEM_PAGE_MASK+1);
+	}
+	return hash;
+}
+
+// *******************************************************************************************************************************
+//		Host local time as seconds since 1970, as if it were UTC, so gmtime() gives it back on any host. Days from the
+//		civil date as in Howard Hinnant's algorithm.
+// *******************************************************************************************************************************
+
+static long long _REPLAYLocalSeconds(void) {
+	time_t t = time(NULL);
+	struct tm *local = localtime(&t);
+	long long y = local->tm_year + 1900 - (local->tm_mon < 2);
+	long long era = (y >= 0 ? y : y-399) / 400;
+	long long yoe = y - era * 400;
+	long long doy = (153 * (local->tm_mon + (local->tm_mon < 2 ? 10 : -2)) + 2) / 5 + local->tm_mday - 1;
+	long long days = era * 146097 + yoe * 365 + yoe / 4 - yoe / 100 + doy - 719468;
+	return days * 86400 + local->tm_hour * 3600 + local->tm_min * 60 + local->tm_sec;
+}
+
+// *******************************************************************************************************************************
+//										Log header, written and read field by field
+// *******************************************************************************************************************************
+
+typedef struct _ReplayHeader {
+	LONG32 version;
+	unsigned long long romHash,startHash;
+	long long rtcStart;
+	SCHEDTIME rtcCycle;
+} REPLAYHEADER;
+
+#define REPLAYFIELD(x) 	ok = ok && (write ? fwrite(&(x),sizeof(x),1,f) : fread(&(x),sizeof(x),1,f)) == 1
+
+static int _REPLAYFile(FILE *f,REPLAYHEADER *h,int write) {
+	int ok = 1;
+	REPLAYFIELD(h->version);REPLAYFIELD(h->romHash);REPLAYFIELD(h->startHash);
+	REPLAYFIELD(h->rtcStart);REPLAYFIELD(h->rtcCycle);
+	return ok;
+}
+
+static int _REPLAYEventFile(FILE *f,REPLAYEVENT *e,int write) {
+	int ok = 1;
+	REPLAYFIELD(e->time);REPLAYFIELD(e->type);REPLAYFIELD(e->data);
+	return ok;
+}
+
+// *******************************************************************************************************************************
+//		Start recording the current machine to fileName, or replaying a recording, which has to start from the same
+//		machine, so the same ROM, files and options. Return non zero if okay.
+// *******************************************************************************************************************************
+
+static REPLAYLOG *_REPLAYCreate(long long rtcStart,SCHEDTIME rtcCycle) {
+	REPLAYStop();
+	REPLAYLOG *r = new REPLAYLOG();
+	r->file = NULL;r->next = 0;r->result = 0;
+	r->rtcStart = rtcStart;r->rtcCycle = rtcCycle;
+	return r;
+}
+
+int REPLAYRecord(const char *fileName) {
+	if (machine == NULL) CPUReset();
+	FILE *f = fopen(fileName,"wb");
+	if (f == NULL) return 0;
+	REPLAYHEADER h = { REPLAY_VERSION,SNAPROMHash(),_REPLAYHash(),_REPLAYLocalSeconds(),SCHEDGetTime() };
+	if (fwrite(replayMagic,sizeof(replayMagic),1,f) != 1 || !_REPLAYFile(f,&h,1)) {
+		fclose(f);
+		return 0;
+	}
+	machine->replay = _REPLAYCreate(h.rtcStart,h.rtcCycle);
+	machine->replay->file = f;
+	return 1;
+}
+
+static void _REPLAYEvent(int event,SCHEDTIME when);
+
+int REPLAYPlay(const char *fileName) {
+	if (machine == NULL) CPUReset();
+	FILE *f = fopen(fileName,"rb");
+	if (f == NULL) return 0;
+	char magic[sizeof(replayMagic)];
+	REPLAYHEADER h;
+	int ok = fread(magic,sizeof(magic),1,f) == 1 && memcmp(magic,replayMagic,sizeof(magic)) == 0 &&
+						_REPLAYFile(f,&h,0) && h.version == REPLAY_VERSION &&
+						h.romHash == SNAPROMHash() && h.startHash == _REPLAYHash();
+	REPLAYEVENT e;
+	std::vector<REPLAYEVENT> events;
+	while (ok && _REPLAYEventFile(f,&e,0)) {
+		ok = events.empty() || e.time >= events.back().time;						// Must be in order.
+		events.push_back(e);
+	}
+	fclose(f);
+	if (!ok) return 0;
+	machine->replay = _REPLAYCreate(h.rtcStart,h.rtcCycle);
+	machine->replay->events = events;
+	SCHEDSetHandler(SCHED_INPUT,_REPLAYEvent);
+	if (!events.empty()) SCHEDPost(SCHED_INPUT,events[0].time);
+	return 1;
+}
+
+// *******************************************************************************************************************************
+//							Stop, a recording is ended with the time and the hash of the machine
+// *******************************************************************************************************************************
+
+void REPLAYStop(void) {
+	REPLAYLOG *r = machine->replay;
+	if (r == NULL) return;
+	if (r->file != NULL) {
+		REPLAYEVENT e = { SCHEDGetTime(),REPLAY_END,_REPLAYHash() };
+		_REPLAYEventFile(r->file,&e,1);
+		fclose(r->file);
+	} else {
+		SCHEDCancel(SCHED_INPUT);
+		SCHEDSetHandler(SCHED_INPUT,NULL);
+	}
+	delete r;
+	machine->replay = NULL;
+}
+
+int REPLAYIsPlaying(void) {
+	return machine->replay != NULL && machine->replay->file == NULL;
+}
+
+// *******************************************************************************************************************************
+//		Key passed to the machine, logged if recording. Flushed each time, so the log survives the emulator crashing.
+// *******************************************************************************************************************************
+
+void REPLAYKey(int mau) {
+	REPLAYLOG *r = machine->replay;
+	if (r == NULL || r->file == NULL) return;
+	REPLAYEVENT e = { SCHEDGetTime(),REPLAY_KEY,(unsigned long long) mau };
+	_REPLAYEventFile(r->file,&e,1);
+	fflush(r->file);
+}
+
+// *******************************************************************************************************************************
+//		Replay event. It was recorded between slices, after everything then due, so it waits for anything else due at
+//		the same time before passing on all the inputs due, then waits for the next.
+// *******************************************************************************************************************************
+
+static void _REPLAYEvent(int event,SCHEDTIME when) {
+	MACHINE *m = machine;
+	REPLAYLOG *r = m->replay;
+	if (m->heapSize > 0 && m->eventTime[m->heap[0]] <= when) {
+		SCHEDPost(event,when);
+		return;
+	}
+	while (r->next < r->events.size() && r->events[r->next].time <= when) {
+		REPLAYEVENT *e = &r->events[r->next++];
+		if (e->type == REPLAY_KEY) HWKeyEvent((int) e->data);
+		if (e->type == REPLAY_END) {
+			r->result = (e->data == _REPLAYHash()) ? REPLAY_MATCHED : REPLAY_DIFFERS;
+			fprintf(stderr,"Replay %s the recording at cycle %llu\n",
+								r->result == REPLAY_MATCHED ? "matches" : "differs from",(unsigned long long) e->time);
+		}
+	}
+	if (r->next < r->events.size()) SCHEDPost(event,r->events[r->next].time);
+}
+
+// *******************************************************************************************************************************
+//		RTC time, from the cycle count while recording or replaying, otherwise NULL. Broken down as UTC as the start
+//		time is the recording host's local time.
+// *******************************************************************************************************************************
+
+struct tm *REPLAYLocalTime(void) {
+	REPLAYLOG *r = machine->replay;
+	if (r == NULL) return NULL;
+	SCHEDTIME elapsed = (SCHEDGetTime() - r->rtcCycle) / ((SCHEDTIME) CPUGetClock() * 1000000);
+	time_t t = (time_t) (r->rtcStart + (long long) elapsed);
+	return gmtime(&t);
+}
+
+// *******************************************************************************************************************************
+//							Cycle count the recording being replayed ended at, zero if none
+// *******************************************************************************************************************************
+
+SCHEDTIME REPLAYEndTime(void) {
+	if (!REPLAYIsPlaying() || machine->replay->events.empty()) return 0;
+	REPLAYEVENT *e = &machine->replay->events.back();
+	return e->type == REPLAY_END ? e->time : 0;
+}
+
+// *******************************************************************************************************************************
+//				Whether the replay got to the end of the recording and matched it, zero if not there yet or not replaying
+// *******************************************************************************************************************************
+
+int REPLAYResult(void) {
+	return REPLAYIsPlaying() ? machine->replay->result : 0;
+}
+
+// *******************************************************************************************************************************
+// *******************************************************************************************************************************
+//
+//		Changes made
+//
+//		Date 			Changes
+//		---- 			-------
+//		18-10-2026 		The replay records whether it matched, for the -headless exit code.
+//
+// *******************************************************************************************************************************
+// *******************************************************************************************************************************
@@ -0,0 +1,176 @@
+// *******************************************************************************************************************************
+// *******************************************************************************************************************************
+//
+//		Name:		rewind.cpp
+//		Purpose:	Debugger rewind history
+//		Created:	17th October 2026
+//		Author:		agent (agent@local)
+//
+//		The debugger records a point at most once a frame, a snapshot of the pages written since the last one and,
+//		every REWIND_KEYFRAME_GAP points, a full one. Going back restores the keyframe, applies the changes up to the
+//		nearest point before, then runs forward an instruction at a time, which is the same as running it in slices
+//		so long as idle loops aren't skipped. Oldest keyframes are dropped to keep within the memory allowed.
+//
+// *******************************************************************************************************************************
+// *******************************************************************************************************************************
+
+#include <includes.h>
+
+// *******************************************************************************************************************************
+//											Start and stop keeping history
+// *******************************************************************************************************************************
+
+void REWINDStart(int megabytes) {
+	if (machine == NULL) CPUReset();
+	REWINDStop();
+	machine->rewind = new REWINDHISTORY();
+	machine->rewind->bytes = 0;
+	machine->rewind->maxBytes = (size_t) megabytes << 20;
+	machine->rewind->frameTime = 0;
+	m68k_set_idle_skip(0);															// Skipping depends on the slices run.
+}
+
+void REWINDStop(void) {
+	delete machine->rewind;
+	machine->rewind = NULL;
+}
+
+// *******************************************************************************************************************************
+//													History helpers
+// *******************************************************************************************************************************
+
+static void _REWINDTruncate(REWINDHISTORY *h,size_t count) {						// Keep the first count points.
+	while (h->points.size() > count) {
+		h->bytes -= h->points.back().data.size();
+		h->points.pop_back();
+	}
+}
+
+static int _REWINDKeyframe(REWINDHISTORY *h,int n) {								// Keyframe point n is built on.
+	while (!h->points[n].keyframe) n--;
+	return n;
+}
+
+static int _REWINDBefore(REWINDHISTORY *h,SCHEDTIME time) {							// Last point before time, -1 if none.
+	int n = (int) h->points.size()-1;
+	while (n >= 0 && h->points[n].time >= time) n--;
+	return n;
+}
+
+static void _REWINDGoto(REWINDHISTORY *h,int n) {
+	int first = _REWINDKeyframe(h,n);
+	SNAPRestore(h->points[first].data.data(),h->points[first].data.size());
+	for (int i = first+1;i <= n;i++) {
+		SNAPApplyDelta(h->points[i].data.data(),h->points[i].data.size());
+	}
+	MEMClearDirty();																// Later points follow on from here.
+}
+
+static void _REWINDRunTo(SCHEDTIME time) {
+	while (SCHEDGetTime() < time) CPUExecuteInstruction();
+}
+
+// *******************************************************************************************************************************
+//		Record a point if a frame has started since the last one. Called by the debugger before running, so it is
+//		after any keys have been passed to the machine.
+// *******************************************************************************************************************************
+
+void REWINDRecord(void) {
+	REWINDHISTORY *h = machine->rewind;
+	if (h == NULL) return;
+	SCHEDTIME now = SCHEDGetTime();
+	if (!h->points.empty() && now < h->points.back().time) _REWINDTruncate(h,0);	// Reset, start again.
+	if (!h->points.empty() && machine->frameTime == h->frameTime && MEMIsTracking()) return;
+	REWINDPOINT point;
+	point.time = now;
+	point.keyframe = h->points.empty() || !MEMIsTracking() ||						// Written pages unknown.
+				(int) h->points.size()-_REWINDKeyframe(h,(int) h->points.size()-1) >= REWIND_KEYFRAME_GAP;
+	if (point.keyframe) {
+		SNAPCreate(point.data);
+	} else {
+		SNAPCreateDelta(point.data);
+	}
+	MEMClearDirty();
+	h->bytes += point.data.size();
+	h->points.push_back(std::move(point));
+	h->frameTime = machine->frameTime;
+	while (h->bytes > h->maxBytes) {												// Drop the oldest keyframe and
+		size_t next = 1;															// its changes, never the newest.
+		while (next < h->points.size() && !h->points[next].keyframe) next++;
+		if (next >= h->points.size()) break;
+		while (next-- > 0) {
+			h->bytes -= h->points.front().data.size();
+			h->points.pop_front();
+		}
+	}
+}
+
+// *******************************************************************************************************************************
+//		Step back one instruction. The run forward from the point before is done twice, once to find the cycle the
+//		last instruction started at, then to stop there. Returns zero if there is no history to go back to.
+// *******************************************************************************************************************************
+
+int REWINDStepBack(void) {
+	REWINDHISTORY *h = machine->rewind;
+	if (h == NULL) return 0;
+	SCHEDTIME now = SCHEDGetTime();
+	int n = _REWINDBefore(h,now);
+	if (n < 0) return 0;
+	_REWINDGoto(h,n);
+	SCHEDTIME last = SCHEDGetTime();
+	while (SCHEDGetTime() < now) {
+		last = SCHEDGetTime();
+		CPUExecuteInstruction();
+	}
+	_REWINDGoto(h,n);
+	_REWINDRunTo(last);
+	_REWINDTruncate(h,n+1);															// Anything later is run again.
+	h->frameTime = machine->frameTime;
+	return 1;
+}
+
+// *******************************************************************************************************************************
+//		Run back to the last time the PC was at breakPoint or any other breakpoint, searching back a point at a time.
+//		If it never was this stops at the oldest point kept and returns zero.
+// *******************************************************************************************************************************
+
+int REWINDRunBack(LONG32 breakPoint) {
+	REWINDHISTORY *h = machine->rewind;
+	if (h == NULL || h->points.empty()) return 0;
+	SCHEDTIME end = SCHEDGetTime();
+	for (int n = _REWINDBefore(h,end);n >= 0;n--) {
+		int hit = 0;
+		SCHEDTIME found = 0;
+		_REWINDGoto(h,n);
+		while (SCHEDGetTime() < end) {												// Last breakpoint before end.
+			LONG32 pc = m68k_get_reg(NULL,M68K_REG_PC);
+			if (pc == breakPoint || CPUIsBreakpoint(pc)) {
+				hit = 1;found = SCHEDGetTime();
+			}
+			CPUExecuteInstruction();
+		}
+		if (hit) {
+			_REWINDGoto(h,n);
+			_REWINDRunTo(found);
+			_REWINDTruncate(h,n+1);
+			h->frameTime = machine->frameTime;
+			return 1;
+		}
+		end = h->points[n].time;
+	}
+	_REWINDGoto(h,0);																// Not found, as far back as it goes.
+	_REWINDTruncate(h,1);
+	h->frameTime = machine->frameTime;
+	return 0;
+}
+
+// *******************************************************************************************************************************
+// *******************************************************************************************************************************
+//
+//		Changes made
+//
+//		Date 			Changes
+//		---- 			-------
+//
+// *******************************************************************************************************************************
+// *******************************************************************************************************************************
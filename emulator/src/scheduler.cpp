@@ -0,0 +1,164 @@
+// *******************************************************************************************************************************
+// *******************************************************************************************************************************
+//
+//		Name:		scheduler.cpp
+//		Purpose:	Hardware event scheduler
+//		Created:	17th October 2026
+//		Author:		agent (agent@local)
+//
+//		Devices post events at an absolute CPU cycle, the CPU is run in slices up to the next event, which is then
+//		dispatched. Events are kept in a binary min-heap, one slot per event so posting again moves it.
+//
+// *******************************************************************************************************************************
+// *******************************************************************************************************************************
+
+#include <includes.h>
+
+// *******************************************************************************************************************************
+//												Heap maintenance
+// *******************************************************************************************************************************
+
+static void _SCHEDSwap(int a,int b) {
+	MACHINE *m = machine;
+	int t = m->heap[a];m->heap[a] = m->heap[b];m->heap[b] = t;
+	m->eventSlot[m->heap[a]] = a;m->eventSlot[m->heap[b]] = b;
+}
+
+static void _SCHEDSiftUp(int n) {
+	MACHINE *m = machine;
+	while (n > 0 && m->eventTime[m->heap[n]] < m->eventTime[m->heap[(n-1)/2]]) {
+		_SCHEDSwap(n,(n-1)/2);
+		n = (n-1)/2;
+	}
+}
+
+static void _SCHEDSiftDown(int n) {
+	MACHINE *m = machine;
+	while (1) {
+		int smallest = n;
+		int c = n * 2 + 1;
+		if (c < m->heapSize && m->eventTime[m->heap[c]] < m->eventTime[m->heap[smallest]]) smallest = c;
+		if (c+1 < m->heapSize && m->eventTime[m->heap[c+1]] < m->eventTime[m->heap[smallest]]) smallest = c+1;
+		if (smallest == n) return;
+		_SCHEDSwap(n,smallest);
+		n = smallest;
+	}
+}
+
+// *******************************************************************************************************************************
+//													Reset scheduler
+// *******************************************************************************************************************************
+
+void SCHEDReset(void) {
+	MACHINE *m = machine;
+	for (int i = 0;i < SCHED_EVENTS;i++) {
+		m->eventSlot[i] = -1;m->eventHandler[i] = NULL;
+	}
+	m->heapSize = 0;
+	m->now = m->sliceEnd = 0;
+}
+
+// *******************************************************************************************************************************
+//												Set the handler for an event
+// *******************************************************************************************************************************
+
+void SCHEDSetHandler(int event,SCHEDHANDLER handler) {
+	machine->eventHandler[event] = handler;
+}
+
+// *******************************************************************************************************************************
+//								Post an event, replacing any pending one in the same slot
+// *******************************************************************************************************************************
+
+void SCHEDPost(int event,SCHEDTIME when) {
+	MACHINE *m = machine;
+	if (m->eventSlot[event] < 0) {													// Add to end of heap
+		m->eventSlot[event] = m->heapSize;
+		m->heap[m->heapSize++] = event;
+	}
+	m->eventTime[event] = when;
+	_SCHEDSiftUp(m->eventSlot[event]);
+	_SCHEDSiftDown(m->eventSlot[event]);
+	if (m->running && when < m->sliceEnd) {											// Due before the CPU would stop.
+		m->sliceEnd = when;
+		m68k_end_timeslice();
+	}
+}
+
+// *******************************************************************************************************************************
+//													Cancel an event
+// *******************************************************************************************************************************
+
+void SCHEDCancel(int event) {
+	MACHINE *m = machine;
+	int n = m->eventSlot[event];
+	if (n < 0) return;
+	m->eventSlot[event] = -1;
+	if (n == --m->heapSize) return;													// Was the last one.
+	m->heap[n] = m->heap[m->heapSize];m->eventSlot[m->heap[n]] = n;					// Move last into the gap.
+	_SCHEDSiftUp(n);
+	_SCHEDSiftDown(n);
+}
+
+int SCHEDIsPending(int event) {
+	return machine->eventSlot[event] >= 0;
+}
+
+// *******************************************************************************************************************************
+//							Get current time, includes cycles used so far in the current slice
+// *******************************************************************************************************************************
+
+SCHEDTIME SCHEDGetTime(void) {
+	return machine->running ? machine->now + m68k_cycles_run() : machine->now;
+}
+
+// *******************************************************************************************************************************
+//		Dispatch all events now due. An event may change what an idle loop is polling, so the CPU has to run the loop
+//		again before it can be skipped.
+// *******************************************************************************************************************************
+
+static void _SCHEDDispatch(void) {
+	MACHINE *m = machine;
+	while (m->heapSize > 0 && m->eventTime[m->heap[0]] <= m->now) {
+		int event = m->heap[0];
+		SCHEDTIME when = m->eventTime[event];
+		SCHEDCancel(event); 														// Handler may post it again.
+		if (m->eventHandler[event] != NULL) (*m->eventHandler[event])(event,when);
+		m68k_forget_idle_loop();
+	}
+}
+
+// *******************************************************************************************************************************
+//		Run the CPU up to the next event or for maxCycles, whichever is sooner, then dispatch anything due. maxCycles
+//		of zero runs a single instruction. Returns cycles used. A CPU which is stopped, or polling in an idle loop, uses
+//		the whole slice at once, so time jumps straight to the next event.
+// *******************************************************************************************************************************
+
+int SCHEDRun(int maxCycles) {
+	MACHINE *m = machine;
+	_SCHEDDispatch();
+	int budget = maxCycles;
+	if (m->heapSize > 0 && m->eventTime[m->heap[0]] - m->now < (SCHEDTIME) budget) {
+		budget = (int) (m->eventTime[m->heap[0]] - m->now);
+	}
+	m->sliceEnd = m->now + budget;
+	m->running = 1;
+	int used = m68k_execute(budget);
+	m->running = 0;
+	m->now += used;
+	_SCHEDDispatch();
+	return used;
+}
+
+// *******************************************************************************************************************************
+// *******************************************************************************************************************************
+//
+//		Changes made
+//
+//		Date 			Changes
+//		---- 			-------
+//		17-10-2026 		Event heap is in the current MACHINE.
+//		18-10-2026 		Dispatching an event makes the CPU forget any idle loop it was skipping.
+//
+// *******************************************************************************************************************************
+// *******************************************************************************************************************************
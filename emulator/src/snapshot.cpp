@@ -0,0 +1,407 @@
+// *******************************************************************************************************************************
+// *******************************************************************************************************************************
+//
+//		Name:		snapshot.cpp
+//		Purpose:	Machine snapshots
+//		Created:	17th October 2026
+//		Author:		agent (agent@local)
+//
+//		A snapshot is the CPU state, the device and scheduler state of the MACHINE and all its RAM. RAM is stored
+//		in 64k pages, all zero pages as just their length and the rest packed with a small LZ77 codec. Flash isn't
+//		stored, it is reloaded from the ROM file, whose hash has to match. Event handlers are host addresses, so
+//		they are set up by a reset before the state is loaded over it. Snapshots are for the build which made them,
+//		and end with a hash of the rest so a damaged one is refused.
+//
+// *******************************************************************************************************************************
+// *******************************************************************************************************************************
+
+#include <includes.h>
+
+static const char snapMagic[8] = "F68SNAP";
+
+#define SNAP_PAGE 		(1 << MEM_PAGE_SHIFT)										// RAM is saved in pages this size.
+
+// *******************************************************************************************************************************
+//		LZ77 codec. Each sequence is a token byte, literal count in the upper nibble and match length-4 in the lower,
+//		15 in either being extended by following bytes until one isn't 255. Then the literals, then a two byte
+//		offset back to the match. The last sequence is literals only.
+// *******************************************************************************************************************************
+
+#define LZ_MIN_MATCH 	(4)
+#define LZ_HASH_BITS 	(12)
+#define LZ_MAX_SIZE(n) 	((n) + (n) / 255 + 16)										// Worst case packed size.
+
+static int _LZWriteLength(BYTE8 *dst,int op,int n) {
+	while (n >= 255) {
+		dst[op++] = 255;n -= 255;
+	}
+	dst[op++] = n;
+	return op;
+}
+
+static int _LZSequence(BYTE8 *dst,int op,const BYTE8 *literals,int count,int offset,int length) {
+	int extra = (length != 0) ? length - LZ_MIN_MATCH : 0;
+	dst[op++] = (std::min(count,15) << 4) | std::min(extra,15);
+	if (count >= 15) op = _LZWriteLength(dst,op,count-15);
+	memcpy(dst+op,literals,count);
+	op += count;
+	if (length != 0) {
+		dst[op++] = offset & 0xFF;dst[op++] = offset >> 8;
+		if (extra >= 15) op = _LZWriteLength(dst,op,extra-15);
+	}
+	return op;
+}
+
+static int _LZCompress(const BYTE8 *src,int size,BYTE8 *dst) {
+	int table[1 << LZ_HASH_BITS];													// Last position of each hashed 4 bytes
+	for (int i = 0;i < (1 << LZ_HASH_BITS);i++) table[i] = -1;
+	int ip = 0,anchor = 0,op = 0;
+	while (ip + LZ_MIN_MATCH <= size) {
+		LONG32 quad;
+		memcpy(&quad,src+ip,sizeof(quad));
+		int h = (quad * 2654435761U) >> (32-LZ_HASH_BITS);
+		int ref = table[h];
+		table[h] = ip;
+		if (ref < 0 || ip - ref > 0xFFFF || memcmp(src+ref,src+ip,LZ_MIN_MATCH) != 0) {
+			ip++;continue;
+		}
+		int length = LZ_MIN_MATCH;
+		while (ip + length < size && src[ref+length] == src[ip+length]) length++;
+		op = _LZSequence(dst,op,src+anchor,ip-anchor,ip-ref,length);
+		ip += length;anchor = ip;
+	}
+	return _LZSequence(dst,op,src+anchor,size-anchor,0,0);
+}
+
+static int _LZReadLength(const BYTE8 *src,int size,int *ip) {
+	int n = 0,b;
+	do {
+		if (*ip >= size) return -1;
+		b = src[(*ip)++];
+		n += b;
+	} while (b == 255);
+	return n;
+}
+
+static int _LZExpand(const BYTE8 *src,int size,BYTE8 *dst,int dstSize) {
+	int ip = 0,op = 0;
+	while (ip < size) {
+		int token = src[ip++];
+		int count = token >> 4;
+		if (count == 15) {
+			int more = _LZReadLength(src,size,&ip);
+			if (more < 0) return -1;
+			count += more;
+		}
+		if (count > size - ip || count > dstSize - op) return -1;
+		memcpy(dst+op,src+ip,count);
+		ip += count;op += count;
+		if (ip == size) break;														// Last sequence, no match.
+		if (size - ip < 2) return -1;
+		int offset = src[ip] | (src[ip+1] << 8);
+		ip += 2;
+		int length = (token & 15) + LZ_MIN_MATCH;
+		if ((token & 15) == 15) {
+			int more = _LZReadLength(src,size,&ip);
+			if (more < 0) return -1;
+			length += more;
+		}
+		if (offset == 0 || offset > op || length > dstSize - op) return -1;
+		for (int i = 0;i < length;i++) {											// Byte by byte, it may overlap.
+			dst[op+i] = dst[op-offset+i];
+		}
+		op += length;
+	}
+	return op;
+}
+
+// *******************************************************************************************************************************
+//		Snapshots are read and written by the same code, a stream writing to out if it isn't NULL, otherwise reading
+//		from in. A short read clears ok and reads nothing more.
+// *******************************************************************************************************************************
+
+typedef struct _SnapStream {
+	std::vector<BYTE8> *out;
+	const BYTE8 *in;
+	size_t pos,size;
+	int ok;
+} SNAPSTREAM;
+
+static void _SNAPData(SNAPSTREAM *s,void *data,size_t size) {
+	if (s->out != NULL) {
+		s->out->insert(s->out->end(),(BYTE8 *) data,(BYTE8 *) data + size);
+		return;
+	}
+	if (!s->ok || s->size - s->pos < size) {
+		s->ok = 0;return;
+	}
+	memcpy(data,s->in+s->pos,size);
+	s->pos += size;
+}
+
+#define SNAPFIELD(s,f) 	_SNAPData(s,&(f),sizeof(f))
+
+// *******************************************************************************************************************************
+//								Device, scheduler and processor state, everything but memory and handlers
+// *******************************************************************************************************************************
+
+static void _SNAPDevices(SNAPSTREAM *s) {
+	MACHINE *m = machine;
+	SNAPFIELD(s,m->icr);SNAPFIELD(s,m->mauQueue);
+	SNAPFIELD(s,m->timers);SNAPFIELD(s,m->tcr);
+	SNAPFIELD(s,m->eventTime);SNAPFIELD(s,m->eventSlot);
+	SNAPFIELD(s,m->heap);SNAPFIELD(s,m->heapSize);
+	SNAPFIELD(s,m->now);SNAPFIELD(s,m->sliceEnd);
+	SNAPFIELD(s,m->frameTime);SNAPFIELD(s,m->frameComplete);
+	SNAPFIELD(s,m->resetJumpAddress);SNAPFIELD(s,m->clock);
+}
+
+static int _SNAPCheckScheduler(void) {												// The heap indexes arrays.
+	MACHINE *m = machine;
+	if (m->heapSize < 0 || m->heapSize > SCHED_EVENTS) return 0;
+	int pending = 0;
+	for (int i = 0;i < SCHED_EVENTS;i++) {
+		int n = m->eventSlot[i];
+		if (n >= m->heapSize || (n >= 0 && m->heap[n] != i)) return 0;
+		if (n >= 0) pending++;
+	}
+	return pending == m->heapSize;
+}
+
+// *******************************************************************************************************************************
+//							A block of RAM, each page saved as its size in the file then the data
+// *******************************************************************************************************************************
+
+static void _SNAPMemory(SNAPSTREAM *s,BYTE8 *memory,LONG32 size) {
+	static const BYTE8 zeroPage[SNAP_PAGE] = { 0 };
+	static M68K_THREAD_LOCAL BYTE8 packed[LZ_MAX_SIZE(SNAP_PAGE)];
+	for (LONG32 base = 0;base < size && s->ok;base += SNAP_PAGE) {
+		BYTE8 *page = memory + base;
+		LONG32 length = std::min(size - base,(LONG32) SNAP_PAGE);
+		LONG32 stored;
+		if (s->out != NULL) {
+			if (memcmp(page,zeroPage,length) == 0) {								// Zero, just the size.
+				stored = 0;
+				SNAPFIELD(s,stored);
+				continue;
+			}
+			stored = _LZCompress(page,length,packed);
+			if (stored >= length) {													// Didn't pack, stored as it is.
+				SNAPFIELD(s,length);
+				_SNAPData(s,page,length);
+			} else {
+				SNAPFIELD(s,stored);
+				_SNAPData(s,packed,stored);
+			}
+		} else {
+			SNAPFIELD(s,stored);
+			if (!s->ok || stored > s->size - s->pos) {
+				s->ok = 0;return;
+			}
+			if (stored == 0) {
+				if (memcmp(page,zeroPage,length) != 0) memset(page,0,length);		// Untouched pages stay that way.
+			} else if (stored == length) {
+				_SNAPData(s,page,length);
+			} else {
+				if (_LZExpand(s->in+s->pos,stored,page,length) != (int) length) s->ok = 0;
+				s->pos += stored;
+			}
+		}
+	}
+}
+
+static void _SNAPAllMemory(SNAPSTREAM *s) {
+	_SNAPMemory(s,machine->ramMemory,SRAM_END);
+	_SNAPMemory(s,machine->videoMemory,VRAM_SIZE);
+	_SNAPMemory(s,machine->hwMemory,HARDWARE_RAM);
+	#ifdef SDRAM_ENABLED
+	_SNAPMemory(s,machine->sdMemory,SDRAM_SIZE);
+	#endif
+}
+
+// *******************************************************************************************************************************
+//									FNV-1a hash, of the Flash ROM and of the snapshot itself
+// *******************************************************************************************************************************
+
+unsigned long long SNAPHash(const BYTE8 *data,size_t size) {
+	unsigned long long hash = 0xCBF29CE484222325ULL;
+	for (size_t i = 0;i < size;i++) {
+		hash = (hash ^ data[i]) * 0x100000001B3ULL;
+	}
+	return hash;
+}
+
+unsigned long long SNAPROMHash(void) {
+	return SNAPHash(machine->flashMemory,FLASH_SIZE);
+}
+
+// *******************************************************************************************************************************
+//		Snapshot the current machine into snap. It must not be running, so between CPURunBatch(), CPUExecute() or
+//		CPUExecuteInstruction() calls.
+// *******************************************************************************************************************************
+
+void SNAPCreate(std::vector<BYTE8> &snap) {
+	SNAPSTREAM s = { &snap,NULL,0,0,1 };
+	LONG32 version = SNAP_VERSION;
+	LONG32 stateSize = m68k_state_size();
+	unsigned long long romHash = SNAPROMHash();
+	std::vector<BYTE8> state(stateSize);
+	m68k_get_state(state.data());
+	snap.clear();
+	_SNAPData(&s,(void *) snapMagic,sizeof(snapMagic));
+	SNAPFIELD(&s,version);SNAPFIELD(&s,stateSize);SNAPFIELD(&s,romHash);
+	_SNAPData(&s,state.data(),stateSize);
+	_SNAPDevices(&s);
+	_SNAPAllMemory(&s);
+	unsigned long long check = SNAPHash(snap.data(),snap.size());
+	SNAPFIELD(&s,check);
+}
+
+// *******************************************************************************************************************************
+//		Restore a snapshot to the current machine. Returns zero if it is damaged or from another build, leaving the
+//		machine alone, or if it is for another ROM, leaving the machine reset.
+// *******************************************************************************************************************************
+
+static void _SNAPReset(int resetJumpAddress,int clock) {							// Full reset, not to a loaded program.
+	machine->resetJumpAddress = 0;
+	CPUReset();
+	machine->resetJumpAddress = resetJumpAddress;
+	machine->clock = clock;
+}
+
+int SNAPRestore(const BYTE8 *snap,size_t size) {
+	unsigned long long check;
+	if (size < sizeof(check)) return 0;
+	size -= sizeof(check);															// Hash of the rest is on the end.
+	memcpy(&check,snap+size,sizeof(check));
+	if (check != SNAPHash(snap,size)) return 0;
+	SNAPSTREAM s = { NULL,snap,0,size,1 };
+	char magic[sizeof(snapMagic)];
+	LONG32 version,stateSize;
+	unsigned long long romHash;
+	_SNAPData(&s,magic,sizeof(magic));
+	SNAPFIELD(&s,version);SNAPFIELD(&s,stateSize);SNAPFIELD(&s,romHash);
+	if (!s.ok || memcmp(magic,snapMagic,sizeof(magic)) != 0 ||						// Not one of ours, leave it alone.
+							version != SNAP_VERSION || stateSize != m68k_state_size()) return 0;
+	if (machine == NULL) CPUReset();												// Creates one.
+	int resetJumpAddress = machine->resetJumpAddress,clock = machine->clock;
+	_SNAPReset(resetJumpAddress,clock);												// Handlers, Flash and page tables.
+	std::vector<BYTE8> state(stateSize);
+	_SNAPData(&s,state.data(),stateSize);
+	s.ok = s.ok && romHash == SNAPROMHash() && m68k_set_state(state.data());
+	_SNAPDevices(&s);
+	_SNAPAllMemory(&s);
+	if (!s.ok || s.pos != s.size || !_SNAPCheckScheduler()) {
+		_SNAPReset(resetJumpAddress,clock);
+		return 0;
+	}
+	m68k_flush_code_cache();														// Memory was written behind its back.
+	m68k_forget_idle_loop();
+	machine->idleReads = 1;
+	return 1;
+}
+
+// *******************************************************************************************************************************
+//		Changes since MEMClearDirty(), the CPU and device state and the pages written, for the rewind history. The
+//		state is packed like a page, the ATCs are mostly empty. Applied to the same machine in the same run.
+// *******************************************************************************************************************************
+
+void SNAPCreateDelta(std::vector<BYTE8> &snap) {
+	SNAPSTREAM s = { &snap,NULL,0,0,1 };
+	std::vector<BYTE8> state(m68k_state_size());
+	m68k_get_state(state.data());
+	snap.clear();
+	_SNAPMemory(&s,state.data(),state.size());
+	_SNAPDevices(&s);
+	for (LONG32 page = 0;page < MEM_PAGES;page++) {
+		BYTE8 *host = MEMGetDirtyPage(page);
+		if (host != NULL) {
+			SNAPFIELD(&s,page);
+			_SNAPMemory(&s,host,SNAP_PAGE);
+		}
+	}
+	LONG32 end = MEM_PAGES;
+	SNAPFIELD(&s,end);
+}
+
+int SNAPApplyDelta(const BYTE8 *snap,size_t size) {
+	SNAPSTREAM s = { NULL,snap,0,size,1 };
+	std::vector<BYTE8> state(m68k_state_size());
+	_SNAPMemory(&s,state.data(),state.size());
+	s.ok = s.ok && m68k_set_state(state.data());
+	_SNAPDevices(&s);
+	LONG32 page = 0;
+	while (s.ok && page < MEM_PAGES) {
+		SNAPFIELD(&s,page);
+		if (page < MEM_PAGES && MEMGetRAMPage(page) != NULL) {
+			_SNAPMemory(&s,MEMGetRAMPage(page),SNAP_PAGE);
+		} else if (page < MEM_PAGES) {
+			s.ok = 0;
+		}
+	}
+	m68k_flush_code_cache(); 														// Memory was written behind its back.
+	m68k_forget_idle_loop();
+	return s.ok && s.pos == s.size;
+}
+
+// *******************************************************************************************************************************
+//									Save and load snapshot files, return non zero if okay
+// *******************************************************************************************************************************
+
+int SNAPSaveFile(const char *fileName) {
+	std::vector<BYTE8> snap;
+	SNAPCreate(snap);
+	FILE *f = fopen(fileName,"wb");
+	if (f == NULL) return 0;
+	int ok = (fwrite(snap.data(),1,snap.size(),f) == snap.size());
+	return (fclose(f) == 0) && ok;
+}
+
+int SNAPLoadFile(const char *fileName) {
+	FILE *f = fopen(fileName,"rb");
+	if (f == NULL) return 0;
+	std::vector<BYTE8> snap;
+	BYTE8 buffer[65536];
+	size_t n;
+	while ((n = fread(buffer,1,sizeof(buffer),f)) > 0) snap.insert(snap.end(),buffer,buffer+n);
+	fclose(f);
+	return SNAPRestore(snap.data(),snap.size());
+}
+
+// *******************************************************************************************************************************
+//		Fast boot. The machine, just reset, is restored from the snapshot taken when this ROM last booted to stopPC, or
+//		to its prompt if that is zero. If there isn't one it is booted and the snapshot saved for next time. Returns
+//		zero, leaving the machine reset, if the boot doesn't finish.
+// *******************************************************************************************************************************
+
+#ifdef INCLUDE_DEBUGGING_SUPPORT
+
+int SNAPFastBoot(LONG32 stopPC) {
+	char fileName[64];
+	if (machine == NULL) CPUReset();
+	snprintf(fileName,sizeof(fileName),SNAP_FASTBOOT,SNAPROMHash(),stopPC);
+	if (SNAPLoadFile(fileName)) return 1;
+	if (!CPUBoot(stopPC,SNAP_BOOT_FRAMES)) {
+		_SNAPReset(machine->resetJumpAddress,machine->clock);
+		return 0;
+	}
+	if (!SNAPSaveFile(fileName)) fprintf(stderr,"Fast boot snapshot %s can't be saved\n",fileName);
+	return 1;
+}
+
+#endif
+
+// *******************************************************************************************************************************
+// *******************************************************************************************************************************
+//
+//		Changes made
+//
+//		Date 			Changes
+//		---- 			-------
+//		17-10-2026 		Added fast boot.
+//		17-10-2026 		Added snapshots of the pages written, for rewinding.
+//		17-10-2026 		Hash is public, replays check the machine with it.
+//		17-10-2026 		Restoring a zero page doesn't write it if it is already zero.
+//
+// *******************************************************************************************************************************
+// *******************************************************************************************************************************
@@ -13,113 +13,174 @@
 
 // *******************************************************************************************************************************
 //
-// 											Extract Hex from SREC
+// 								Hex digit values, SREC_BAD for anything that isn't one
 //
 // *******************************************************************************************************************************
 
-static int _SRecGetHex(char *s,int c) {
-	int n = 0;
-	while (c-- > 0) {
-		int ch = toupper(*s);
-		s++;
-		if (ch >= 'A' && ch <= 'F') ch = ch - 7;
-		n = n * 16 + (ch & 0x0F);
+#define SREC_BAD 		(0xFF)
+#define SREC_MAX_BYTES 	(256) 															// Count byte and up to 255 more.
+
+static BYTE8 hexDigit[256];
+
+static int _SRECBuildHexTable(void) {
+	memset(hexDigit,SREC_BAD,sizeof(hexDigit));
+	for (int i = 0;i < 10;i++) hexDigit['0'+i] = i;
+	for (int i = 0;i < 6;i++) hexDigit['A'+i] = hexDigit['a'+i] = 10+i;
+	return 1;
+}
+
+static int hexTableBuilt = _SRECBuildHexTable();
+
+// *******************************************************************************************************************************
+//
+// 		Decode the hex pairs of a line into bytes, returning how many, or -1 if there is something which isn't hex
+//
+// *******************************************************************************************************************************
+
+static int _SRECDecode(const BYTE8 *line,size_t length,BYTE8 *bytes) {
+	if (length % 2 != 0 || length / 2 > SREC_MAX_BYTES) return -1;
+	int bad = 0;
+	for (size_t i = 0;i < length / 2;i++) {
+		int high = hexDigit[line[i*2]],low = hexDigit[line[i*2+1]];
+		bad |= (high | low) & 0xF0;
+		bytes[i] = (high << 4) | low;
 	}
-	return n;
+	return bad ? -1 : (int) (length / 2);
+}
+
+static BYTE8 _SRECSum(const BYTE8 *bytes,int size) {
+	BYTE8 sum = 0;
+	while (size-- > 0) sum += *bytes++;
+	return sum;
+}
+
+static LONG32 _SRECAddress(const BYTE8 *bytes,int size) {
+	LONG32 a = 0;
+	while (size-- > 0) a = (a << 8) | *bytes++;
+	return a;
 }
 
 // *******************************************************************************************************************************
 //
-// 											Process one line of intel code
+// 		Data is gathered into runs, contiguous lines are written to memory in one go. Flushed when a line doesn't
+//		follow on, and at the end.
 //
 // *******************************************************************************************************************************
 
-static int upper16bits = 0; 
+typedef struct _SRecRun {
+	LONG32 address;
+	std::vector<BYTE8> data;
+} SRECRUN;
 
-static void _SRECProcessIntel(char *line) {
-	int a,count;
+static void _SRECFlush(SRECRUN *run) {
+	if (!run->data.empty()) MEMWriteBlock(run->address,run->data.data(),run->data.size());
+	run->data.clear();
+}
+
+static void _SRECWrite(SRECRUN *run,LONG32 address,const BYTE8 *data,int count) {
+	if (run->address + run->data.size() != address) {
+		_SRECFlush(run);
+		run->address = address;
+	}
+	run->data.insert(run->data.end(),data,data+count);
+}
+
+// *******************************************************************************************************************************
+//
+// 		Process one line of intel code, the bytes after the ':'. Returns zero if the length is wrong.
+//
+// *******************************************************************************************************************************
 
-	switch(line[8]) {
-		case '4':												// 04 sets upper 16 bits
-			a = _SRecGetHex(line+9,4);
-			upper16bits = (a << 16);
+static int _SRECProcessIntel(SRECRUN *run,const BYTE8 *b,int n,LONG32 *upper16bits) {
+	if (n < 5 || b[0] != n-5) return 0;
+	switch(b[3]) {
+		case 0x04:												// 04 sets upper 16 bits
+			*upper16bits = _SRECAddress(b+4,2) << 16;
 			break;
 
-		case '0':												// 00 is a data line.
-			count = _SRecGetHex(line+1,2);						// byte count
-			a = _SRecGetHex(line+3,4)|upper16bits;	 			// Load address
-			for (int i = 0;i < count;i++) {
-				int b = _SRecGetHex(line+9+i*2,2);
-				m68k_write_memory_8(a+i,b); 	// Copy into memory.
-			}
+		case 0x00:												// 00 is a data line.
+			_SRECWrite(run,_SRECAddress(b+1,2)|*upper16bits,b+4,b[0]);
 			break;
 
-		case '5':												// 05 is start address
-			a = _SRecGetHex(line+9,8);
-			CPUOverrideReset(a);
+		case 0x05:												// 05 is start address
+			CPUOverrideReset(_SRECAddress(b+4,4));
 			break;
 	}
+	return 1;
 }
 
 // *******************************************************************************************************************************
 //
-// 											Process one line of motorola code
+// 		Process one line of motorola code, the bytes after the 'Sn'. Returns zero if the length is wrong.
 //
 // *******************************************************************************************************************************
 
-static void _SRECProcessMotorola(char *line) {
-	int a,count;
-	switch(line[1]) {
+static int _SRECProcessMotorola(SRECRUN *run,int type,const BYTE8 *b,int n) {
+	if (n < 2 || b[0] != n-1) return 0;
+	switch(type) {
 
 		case '2':								// S2 is a data line (24 bit)
-			count = _SRecGetHex(line+2,2)-3-1;	// 3 for address, 1 for checksum which I ignore
-			a = _SRecGetHex(line+4,6); 			// Load address
-			for (int i = 0;i < count;i++) {
-				int b = _SRecGetHex(line+10+i*2,2);
-				m68k_write_memory_8(a+i,b); 	// Copy into memory.
-			}
+			if (n >= 5) _SRECWrite(run,_SRECAddress(b+1,3),b+4,n-5);
 			break;
 
 		case '3':								// S3 is a data line (32 bit)
-			count = _SRecGetHex(line+2,2)-4-1;	// 4 for address, 1 for checksum which I ignore
-			a = _SRecGetHex(line+4,8); 			// Load address
-			for (int i = 0;i < count;i++) {
-				int b = _SRecGetHex(line+12+i*2,2);
-				m68k_write_memory_8(a+i,b); 	// Copy into memory.
-			}
+			if (n >= 6) _SRECWrite(run,_SRECAddress(b+1,4),b+5,n-6);
 			break;
 
 		case '7':								// S7 sets the start address (32 bit)
-			a = _SRecGetHex(line+4,8);
-			CPUOverrideReset(a);
+			if (n >= 6) CPUOverrideReset(_SRECAddress(b+1,4));
 			break;
 
 		case '8':								// S8 sets the start address (24 bit)
-			a = _SRecGetHex(line+4,6);
-			CPUOverrideReset(a);
+			if (n >= 5) CPUOverrideReset(_SRECAddress(b+1,3));
 			break;
 	}
+	return 1;
 }
 
 // *******************************************************************************************************************************
 //
-// 												Handle SREC file
+// 		Handle SREC file. A line which isn't hex or is the wrong length stops the load. A wrong checksum, all the
+//		bytes add up to $FF in Motorola lines and to zero in Intel ones, is reported but the line is still loaded,
+//		as some tools get them wrong.
 //
 // *******************************************************************************************************************************
 
 static void _SRECAttemptLoad(char *fileName) {
-	char buffer[128];
-	upper16bits = 0;
-	FILE *f = fopen(fileName,"r");
-	if (f == NULL)
+	BYTE8 bytes[SREC_MAX_BYTES];
+	LONG32 upper16bits = 0;
+	SRECRUN run = {};
+	size_t size;
+	const BYTE8 *data = FFMTOpen(fileName,&size);
+	if (data == NULL)
 		exit(fprintf(stderr,"Cannot find file %s\n",fileName));
-	while (!feof(f)) {
-		fgets(buffer,sizeof(buffer),f);
-		//printf("[%s]\n",buffer);
-		if (buffer[0] == 'S') _SRECProcessMotorola(buffer);
-		if (buffer[0] == ':') _SRECProcessIntel(buffer);
+	int lineNumber = 0,badSums = 0,firstBad = 0;
+	for (size_t pos = 0;pos < size;) {
+		const BYTE8 *line = data+pos;
+		const BYTE8 *eol = (const BYTE8 *) memchr(line,'\n',size-pos);
+		size_t length = (eol != NULL) ? eol-line : size-pos;
+		pos += length+1;lineNumber++;
+		while (length > 0 && isspace(line[length-1])) length--; 						// Trailing CR or spaces.
+		int ok = 1,sumOk = 1;
+		if (length >= 2 && line[0] == 'S') {
+			int n = _SRECDecode(line+2,length-2,bytes);
+			ok = (n >= 0) && _SRECProcessMotorola(&run,line[1],bytes,n);
+			sumOk = _SRECSum(bytes,n) == 0xFF;
+		}
+		if (length >= 1 && line[0] == ':') {
+			int n = _SRECDecode(line+1,length-1,bytes);
+			ok = (n >= 0) && _SRECProcessIntel(&run,bytes,n,&upper16bits);
+			sumOk = _SRECSum(bytes,n) == 0x00;
+		}
+		if (!ok)
+			exit(fprintf(stderr,"Bad record in %s at line %d\n",fileName,lineNumber));
+		if (!sumOk && badSums++ == 0) firstBad = lineNumber;
 	}
-	fclose(f);
+	if (badSums != 0) {
+		fprintf(stderr,"%s : %d bad checksums, the first at line %d\n",fileName,badSums,firstBad);
+	}
+	_SRECFlush(&run);
+	FFMTClose(data,size);
 }			
 
 // *******************************************************************************************************************************
@@ -158,6 +219,10 @@ int SRECHandler(int argc,char *argv[]) {
 			FFMTLoad(argv[i],FFMT_PGZ);
 			processed = -1;
 		}
+		if (strcmp(fnType,".elf") == 0 || strcmp(fnType,".ELF") == 0) {
+			FFMTLoad(argv[i],FFMT_ELF);
+			processed = -1;
+		}
 
 		if (processed == 0) { 									// Couldn't figure it out, try sRec
 			_SRECAttemptLoad(argv[i]);
@@ -174,6 +239,9 @@ int SRECHandler(int argc,char *argv[]) {
 //		Date 			Changes
 //		---- 			-------
 //		12-03-22 		Some reorganisation to allow different file formats other than SREC.
+//		17-10-2026 		Intel HEX upper address is held for each load, not in a static.
+//		17-10-2026 		Files are mapped, hex decoded by table, checksums checked and lines written in contiguous runs.
+//		17-10-2026 		ELF files.
 //
 // *******************************************************************************************************************************
 // *******************************************************************************************************************************
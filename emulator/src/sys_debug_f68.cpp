@@ -63,6 +63,14 @@ void DBGXRender(int *address,int showDisplay, int scale) {
 		xc = IR;yc = 8;
 		DN(s->sp,8);DN(s->usp,8);DN(s->isp,8);DN(s->cycles,8);
 
+		LONG32 offset;
+		const char *symbol = FFMTFindSymbol(s->pc,&offset);
+		if (symbol != NULL) {
+			snprintf(buffer,sizeof(buffer),offset ? "%s+%x" : "%s",symbol,offset);		// Symbol the PC is in.
+			buffer[DW_WIDTH-IL+4] = '\0';
+			GFXString(GRID(IL-4,12),buffer,GRIDSIZE,DBGC_HIGHLIGHT,-1);
+		}
+
 		n = 0;
 		int a = address[1];																// Dump Memory.
 		for (int row = 16;row < DW_HEIGHT;row++) {
@@ -15,33 +15,118 @@
 //														   Timing
 // *******************************************************************************************************************************
 
-#define CPU_CLOCK 		(25)														// Clock speed (effective)
+#define CPU_CLOCK 		(25)														// Default clock speed in MHz (effective)
 #define FRAME_RATE		(60)														// Frames per second (60Hz)
 
-#define CYCLE_RATE 		(CPU_CLOCK*1000*1000)										// Cycles per second 
+#define CYCLE_RATE 		(_CPUClock()*1000*1000)										// Cycles per second 
 #define CYCLES_PER_FRAME (CYCLE_RATE / FRAME_RATE) 									// Cycles per frame.
 
+static int _CPUClock(void) {
+	return machine->clock != 0 ? machine->clock : CPU_CLOCK;
+}
+
+// *******************************************************************************************************************************
+//									Set or get the clock speed in MHz, setting takes effect from the next frame
+// *******************************************************************************************************************************
+
+void CPUSetClock(int mhz) {
+	machine->clock = mhz;
+}
+
+int CPUGetClock(void) {
+	return _CPUClock();
+}
+
 // *******************************************************************************************************************************
 //														CPU / Memory
 // *******************************************************************************************************************************
 
-static int cycles;																	// Cycle Count.
-static int resetJumpAddress = 0; 													// Override reset address.
+#define EXIT_ADDRESS 	(0xFFFFFFFF) 												// Jumping here exits the emulator.
+
+static M68K_THREAD_LOCAL int batchRun = 0; 											// In CPURunBatch(), which has no window.
+
+M68K_THREAD_LOCAL unsigned char *CPUBreakPages;										// Current machine's breakpoint pages, for the core.
+
+// *******************************************************************************************************************************
+//								Start of frame event, update hardware and interrupts
+// *******************************************************************************************************************************
+
+static void _CPUFrameEvent(int event,SCHEDTIME when) {
+	machine->frameComplete = 1;
+	machine->frameTime = when + CYCLES_PER_FRAME;									// Schedule the next one.
+	SCHEDPost(SCHED_FRAME,machine->frameTime);
+	HWSync();																		// Update any hardware
+	HWStartFrame(when,CYCLES_PER_FRAME); 											// Line interrupts for this frame.
+
+	GAVIN_FlagInterrupt(0,0x01); 								 						// Bit 8 of ICR 1 (Vicky B)
+	GAVIN_FlagInterrupt(1,0x01); 								 						// Bit 0 of ICR 1 (Vicky A)
+	GAVIN_UpdateFrameTimers(); 														// Timers 3 and 4 count frames.
+
+	int level = GAVIN_InterruptLevel();
+	if (level != -1) {
+		m68k_set_irq(level); 															// Interrupt level 5 (Vicky A)
+	}
+}
+
+// *******************************************************************************************************************************
+//			Breakpoints. The core tests the page bitmap inline, and only calls the hook if the page has a breakpoint.
+// *******************************************************************************************************************************
+
+static void _CPUUpdateBreakPage(LONG32 addr) {
+	LONG32 page = addr >> 12;
+	int used = (page == (EXIT_ADDRESS >> 12));
+	for (LONG32 bp : *machine->breakSet) {
+		if ((bp >> 12) == page) used = 1;
+	}
+	if (used) {
+		if ((machine->breakPages[page >> 3] & (1 << (page & 7))) == 0) {			// Idle loop being skipped has to
+			m68k_forget_idle_loop(); 												// run again to hit it.
+		}
+		machine->breakPages[page >> 3] |= (1 << (page & 7));
+	} else {
+		machine->breakPages[page >> 3] &= ~(1 << (page & 7));
+	}
+}
+
+void CPUSetBreakpoint(LONG32 addr) {
+	machine->breakSet->insert(addr);
+	_CPUUpdateBreakPage(addr);
+}
+
+void CPUClearBreakpoint(LONG32 addr) {
+	machine->breakSet->erase(addr);
+	_CPUUpdateBreakPage(addr);
+}
+
+void CPUClearAllBreakpoints(void) {
+	machine->breakSet->clear();
+	memset(machine->breakPages,0,sizeof(machine->breakPages));
+	_CPUUpdateBreakPage(EXIT_ADDRESS);
+}
+
+int CPUIsBreakpoint(LONG32 addr) {
+	return machine->breakSet->count(addr) != 0;
+}
 
 // *******************************************************************************************************************************
-//														Reset the CPU
+//						Reset the CPU, on a new machine if none has been selected on this thread.
 // *******************************************************************************************************************************
 
 void CPUReset(void) {
-	if (resetJumpAddress != 0) {
-		m68k_set_reg(M68K_REG_PC,resetJumpAddress);
+	if (machine == NULL) MACHINESelect(MACHINECreate());
+	if (machine->resetJumpAddress != 0) {
+		m68k_set_reg(M68K_REG_PC,machine->resetJumpAddress);
 	} else {
 		MEMLoadFlashROM();																// Load Flash ROM and copy down.
 		m68k_init();
 		m68k_set_cpu_type(PROCESSOR_TYPE);		 										// Select CPU type.
 		m68k_pulse_reset();																// Reset
+		_CPUUpdateBreakPage(EXIT_ADDRESS); 												// Exit address is always checked.
+		SCHEDReset(); 																	// Clear all events
+		SCHEDSetHandler(SCHED_FRAME,_CPUFrameEvent);
+		machine->frameTime = CYCLES_PER_FRAME;
+		SCHEDPost(SCHED_FRAME,machine->frameTime);										// First frame.
 		HWReset();																		// Reset Hardware
-		cycles = CYCLES_PER_FRAME;
 	}
 	MEMSetAddressLog(1);																// Address log on.
 }
@@ -65,7 +150,7 @@ int CPUInterruptHandler(int n) {
 // *******************************************************************************************************************************
 
 void CPUOverrideReset(int addr) {
-	resetJumpAddress = addr;
+	machine->resetJumpAddress = addr;
 }
 
 // *******************************************************************************************************************************
@@ -83,28 +168,44 @@ void CPUExit(void) {}
 #endif
 
 // *******************************************************************************************************************************
-//												Execute a single instruction
+//							Breakpoint hook, called by the CPU core for instructions in a marked page
 // *******************************************************************************************************************************
 
-int CPUExecuteInstruction(void) {
+int CPUBreakpointHook(unsigned int pc) {
 	#ifdef INCLUDE_DEBUGGING_SUPPORT
-	if (PC == 0xFFFFFFFF) CPUExit();
+	if (pc == EXIT_ADDRESS) {														// Exit address.
+		if (!batchRun) CPUExit(); 													// Batch runs just stop, D0 is the result.
+		machine->breakHit = 1;
+		return 1;
+	}
 	#endif
-	cycles -= m68k_execute(0);
-	if (cycles >= 0 ) return 0;														// Not completed a frame.
-	cycles = cycles + CYCLES_PER_FRAME;												// Adjust this frame rate, up to x16 on HS
-	HWSync();																		// Update any hardware
+	if (machine->breakEnabled && machine->breakSet->count(pc) != 0) {				// Stop on breakpoint
+		machine->breakHit = 1;
+		return 1;
+	}
+	return 0;
+}
 
-	GAVIN_FlagInterrupt(0,0x01); 								 						// Bit 8 of ICR 1 (Vicky B)
-	GAVIN_FlagInterrupt(1,0x01); 								 						// Bit 0 of ICR 1 (Vicky A)
+// *******************************************************************************************************************************
+//			MOVE.B D0,D0 ($1000) hook, called by the CPU core before executing it. Non zero stops there, as a breakpoint.
+// *******************************************************************************************************************************
 
-	int level = GAVIN_InterruptLevel();
-	if (level != -1) {
-		m68k_set_irq(level); 															// Interrupt level 5 (Vicky A)
+int CPUMoveD0D0Hook(unsigned int pc) {
+	if (machine->breakEnabled) {
+		machine->breakHit = 1;
+		return 1;
 	}
+	return 0;
+}
+
+// *******************************************************************************************************************************
+//												Execute a single instruction
+// *******************************************************************************************************************************
 
-	GAVIN_UpdateTimers(CYCLES_PER_FRAME,1); 										// Update the timers.
-	return FRAME_RATE;																// Return frame rate.	
+int CPUExecuteInstruction(void) {
+	machine->frameComplete = 0;
+	SCHEDRun(0); 																	// One instruction, then any events due.
+	return machine->frameComplete ? FRAME_RATE : 0;									// Return frame rate if completed a frame.
 }
 
 // *******************************************************************************************************************************
@@ -123,19 +224,76 @@ void CPUWriteMemory(LONG32 address,BYTE8 data) {
 
 // *******************************************************************************************************************************
 //		Execute chunk of code, to either of two break points or frame-out, return non-zero frame rate on frame, breakpoint 0
+//
+//		The CPU core is run in slices up to the next hardware event, the breakpoint hooks end a slice early. The two
+//		breakpoints are added to the breakpoint set for this call only.
 // *******************************************************************************************************************************
 
 BYTE8 CPUExecute(LONG32 breakPoint1,LONG32 breakPoint2) { 
-	BYTE8 next,hitBreak;
-	hitBreak = 0;
-	do {
-		BYTE8 r = CPUExecuteInstruction();											// Execute an instruction
-		if (r != 0) return r; 														// Frame out.
-		if (m68k_read_memory_8(PC) == 0x10) { 										// $1000 is MOVE.B D0,D0
-			if (m68k_read_memory_8(PC+1) == 0x00) hitBreak = 1;
+	int isNew1 = !CPUIsBreakpoint(breakPoint1);
+	if (isNew1) CPUSetBreakpoint(breakPoint1);
+	int isNew2 = !CPUIsBreakpoint(breakPoint2);
+	if (isNew2) CPUSetBreakpoint(breakPoint2);
+
+	machine->breakHit = 0;machine->frameComplete = 0;
+	SCHEDRun(0); 																	// Always execute the first instruction.
+	machine->breakEnabled = 1;
+	while (machine->frameComplete == 0 && machine->breakHit == 0) {					// Until frame out or breakpoint.
+		SCHEDRun(CYCLES_PER_FRAME);													// Run up to the next event.
+	}
+	machine->breakEnabled = 0;
+
+	if (isNew1) CPUClearBreakpoint(breakPoint1);
+	if (isNew2) CPUClearBreakpoint(breakPoint2);
+	if (machine->breakHit) return 0;												// Stopped on breakpoint.
+	return FRAME_RATE; 																// Frame out.
+}
+
+// *******************************************************************************************************************************
+//		Run with no debugger until the program exits through $FFFFFFFF, or frames frames or cycles cycles since reset
+//		have been run, zero for no limit. Breakpoints and MOVE.B D0,D0 are ignored. Returns non zero if it exited, which
+//		prints nothing, so stdout only has what the program wrote.
+// *******************************************************************************************************************************
+
+int CPURunBatch(int frames,SCHEDTIME cycles) {
+	int frameCount = 0;
+	machine->breakHit = 0;
+	batchRun = 1;
+	while (machine->breakHit == 0) {												// Until the exit address is hit.
+		SCHEDTIME now = SCHEDGetTime();
+		if ((frames != 0 && frameCount >= frames) || (cycles != 0 && now >= cycles)) break;
+		int budget = CYCLES_PER_FRAME;
+		if (cycles != 0 && cycles - now < (SCHEDTIME) budget) budget = (int) (cycles - now);
+		machine->frameComplete = 0;
+		SCHEDRun(budget);
+		if (machine->frameComplete) frameCount++;
+	}
+	batchRun = 0;
+	return machine->breakHit;
+}
+
+// *******************************************************************************************************************************
+//		Run from reset until the boot is complete, which is when the PC reaches stopPC or, if that is zero, when the
+//		CPU first sits waiting for input, which needs idle skipping on. Returns zero if it hasn't after maxFrames.
+// *******************************************************************************************************************************
+
+int CPUBoot(LONG32 stopPC,int maxFrames) {
+	unsigned int idleSkips = m68k_idle_skips();
+	int frames = 0;
+	while (frames < maxFrames) {
+		if (stopPC != 0) {
+			if (CPUExecute(stopPC,stopPC) != 0) {
+				frames++;
+			} else if (m68k_get_reg(NULL,M68K_REG_PC) == stopPC) {
+				return 1;
+			}
+		} else {
+			frames++;
+			CPURunBatch(1,0);
+			if (m68k_idle_skips() != idleSkips) return 1;							// Waiting, so it is at the prompt.
 		}
-	} while (PC != breakPoint1 && PC != breakPoint2 && hitBreak == 0);				// Stop on breakpoint or MOVE.B D0,D0
-	return 0; 
+	}
+	return 0;
 }
 
 // *******************************************************************************************************************************
@@ -157,10 +315,10 @@ LONG32 CPUGetStepOverBreakpoint(void) {
 //														Get CPU Status
 // *******************************************************************************************************************************
 
-static CPUSTATUS st;
+static M68K_THREAD_LOCAL CPUSTATUS st;
 
 CPUSTATUS *CPUGetStatus(void) {
-	st.cycles = cycles;
+	st.cycles = (int) (machine->frameTime - SCHEDGetTime());						// Cycles left in this frame.
 	st.pc = m68k_get_reg(NULL, M68K_REG_PC);
 	st.sp = m68k_get_reg(NULL, M68K_REG_SP);
 	st.sr = m68k_get_reg(NULL, M68K_REG_SR);
@@ -194,6 +352,17 @@ CPUSTATUS *CPUGetStatus(void) {
 //	
 //		Date 			Changes
 //		---- 			-------
+//		17-10-2026 		CPUExecute() runs the rest of the frame as one cycle budget, breakpoints are checked by a CPU hook.
+//		17-10-2026 		Frames are driven by a start of frame event from the scheduler.
+//		17-10-2026 		Any number of breakpoints, page bitmap tested by the core. MOVE.B D0,D0 has its own opcode hook.
+//		17-10-2026 		Setting a breakpoint makes the core forget any idle loop it is skipping.
+//		17-10-2026 		State moved to the current MACHINE, so each thread can run its own.
+//		17-10-2026 		Added CPURunBatch() for running without the debugger.
+//		17-10-2026 		Clock speed can be set when running.
+//		17-10-2026 		Added CPUBoot() for taking a fast boot snapshot.
+//		17-10-2026 		Added CPUGetClock() for the replay RTC.
+//		17-10-2026 		MOVE.B D0,D0 stops before the instruction again.
+//		18-10-2026 		Exiting through $FFFFFFFF in CPURunBatch() doesn't print or close the window.
 //
 // *******************************************************************************************************************************
 // *******************************************************************************************************************************
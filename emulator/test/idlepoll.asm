@@ -0,0 +1,27 @@
+; ***********************************************************************************************************
+;
+; 								Headless test : polling loop with interrupts off
+;
+; ***********************************************************************************************************
+;
+;	Waits for ten frames by polling the Vicky A start of frame bit in the Gavin interrupt pending register,
+;	with interrupts masked, then exits through $FFFFFFFF with D0 zero. If the polling loop were skipped
+;	without being run again after each frame, it would never see the bit, and -frames= would stop it with 124.
+;
+;	make test runs it with f68 -headless -frames=300 test/idlepoll.s68
+;
+
+				org 	$10000
+
+start:
+				move.w 	#$2700,sr 					; interrupts off, so the bit has to be polled.
+				moveq 	#10,d0 						; frames to wait for.
+				lea 	$FEC00101,a0 				; ICR 1 pending, bit 0 is Vicky A start of frame.
+				move.b 	#1,(a0) 					; clear it, writing 1 clears a pending bit.
+wait:
+				btst 	#0,(a0) 					; wait for the next frame.
+				beq 	wait
+				move.b 	#1,(a0) 					; clear it again.
+				subq.w 	#1,d0 						; until ten have gone by.
+				bne 	wait
+				jmp 	$FFFFFFFF 					; exit, D0 is the result.